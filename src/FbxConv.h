@@ -41,6 +41,9 @@
 #include "FbxConvCommand.h"
 #include "json/JSONWriter.h"
 #include "json/UBJSONWriter.h"
+#include "json/BlockCompressor.h"
+#include "modeldata/AnimationBank.h"
+#include <sstream>
 #include "readers/FbxConverter.h"
 
 namespace fbxconv {
@@ -142,15 +145,30 @@ class FbxConv {
 		}
 
 		bool save(Settings * const &settings, modeldata::Model *model) {
+			// The animations written to the animation bank are left out of the model file, the bank is only written once the model file 
+			// has been written successfully
+			std::vector<modeldata::Animation *> animations;
+			if (settings->splitAnimations && !model->animations.empty()) {
+				const std::string file = getAnimationBankFile(settings->outFile);
+				const size_t slash = file.find_last_of("/\\");
+				model->animationBank = slash == std::string::npos ? file : file.substr(slash + 1);
+				animations.swap(model->animations);
+			}
+
 			bool result = false;
 			std::ofstream myfile;
 			myfile.open (settings->outFile.c_str(), std::ios::binary);
+			// When compressing blocks, the model is serialized in memory first
+			std::ostringstream buffer;
 
 			json::BaseJSONWriter *jsonWriter = 0;
 			switch(settings->outType) {
 			case FILETYPE_G3DB: 
 				log->status(log::sExportToG3DB, settings->outFile.c_str());
-				jsonWriter = new json::UBJSONWriter(myfile);
+				if (settings->compressBlocks)
+					jsonWriter = new json::UBJSONWriter(buffer);
+				else
+					jsonWriter = new json::UBJSONWriter(myfile);
 				break;
 			case FILETYPE_G3DJ: 
 				log->status(log::sExportToG3DJ, settings->outFile.c_str());
@@ -165,14 +183,70 @@ class FbxConv {
 				(*jsonWriter) << model;
 				delete jsonWriter;
 				result = true;
+				if (settings->compressBlocks)
+					result = compressBlocks(settings, buffer.str(), myfile);
 			}
 
 			log->status(log::sExportClose);
 			myfile.close();
 
+			if (!animations.empty()) {
+				model->animations.swap(animations);
+				result = result && !myfile.fail() && saveAnimationBank(settings, model);
+			}
+			return result;
+		}
+
+		/** Write the animations of the model to the animation bank file next to the output file, the file is removed if that fails */
+		bool saveAnimationBank(Settings * const &settings, modeldata::Model *model) {
+			const std::string file = getAnimationBankFile(settings->outFile);
+			log->status(log::sExportAnimationBank, file.c_str());
+			const bool binary = settings->outType == FILETYPE_G3DB;
+			std::ofstream stream(file.c_str(), std::ios::binary);
+			bool result = stream.is_open() && modeldata::AnimationBank::write(stream, model->animations, settings->animChunkTime,
+				binary ? ANIMATIONBANK_FORMAT_UBJSON : ANIMATIONBANK_FORMAT_JSON, [&](modeldata::Animation * const &chunk, std::string &out) {
+					std::ostringstream buffer;
+					json::BaseJSONWriter *writer = binary ? (json::BaseJSONWriter *)new json::UBJSONWriter(buffer) : new json::JSONWriter(buffer);
+					(*writer) << chunk;
+					delete writer;
+					out = buffer.str();
+				});
+			stream.close();
+			result = result && !stream.fail();
+			if (!result) {
+				log->error(log::eExportAnimationBank, file.c_str());
+				remove(file.c_str());
+			}
 			return result;
 		}
 
+		/** The output file with the extension of an animation bank file */
+		static std::string getAnimationBankFile(const std::string &outFile) {
+			const size_t dot = outFile.find_last_of('.'), slash = outFile.find_last_of("/\\");
+			const bool extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+			return (extension ? outFile.substr(0, dot) : outFile) + ".c3ab";
+		}
+
+		/** Write the serialized model as block compressed container, which is read back to verify the result */
+		bool compressBlocks(Settings * const &settings, const std::string &data, std::ostream &stream) {
+			const unsigned int blockSize = (unsigned int)settings->blockSize * 1024;
+			const unsigned int threads = settings->threads > 0 ? (unsigned int)settings->threads : std::max(1U, std::thread::hardware_concurrency());
+			std::ostringstream container;
+			std::string decompressed;
+			if (!json::BlockCompressor::write(container, data, blockSize, threads)) {
+				log->error(log::eExportCompressBlocks);
+				return false;
+			}
+			const std::string packed = container.str();
+			if (!json::BlockCompressor::read((const unsigned char *)packed.data(), packed.size(), decompressed, threads) || decompressed != data) {
+				log->error(log::eExportCompressBlocks);
+				return false;
+			}
+			log->info(log::iExportCompressBlocks, (int)((data.size() + blockSize - 1) / blockSize), threads, (int)data.size(), (int)packed.size());
+			stream.write(packed.data(), packed.size());
+			return stream.good();
+		}
+
 		void info(modeldata::Model *model) {
 			if (!model)
 				log->verbose(log::iModelInfoNull);
@@ -22,6 +22,7 @@
 #include "Settings.h"
 #include <string>
 #include "log/log.h"
+#include "modeldata/Attributes.h"
 
 namespace fbxconv {
 
@@ -44,13 +45,86 @@ struct FbxConvCommand {
 		settings->maxVertexBonesCount = 4;
 		settings->maxVertexCount = (1<<15)-1;
 		settings->maxIndexCount = (1<<15)-1;
+		settings->indexWidth = INDEXWIDTH_16;
+		settings->packMode = PACKMODE_NONE;
+		settings->staticBatch = false;
+		settings->quantizePositions = false;
+		settings->octahedralBits = 0;
+		settings->uvFormat = UVFORMAT_FLOAT;
+		settings->blendWeightBits = 0;
+		settings->qtangents = false;
+		settings->reduceAttributes = false;
+		settings->indexCodec = false;
+		settings->vertexCodec = false;
+		settings->compressBlocks = false;
+		settings->blockSize = 256;
+		settings->threads = 0;
+		settings->animTolerance = 0.f;
+		settings->animAngleTolerance = 0.5f;
+		settings->animCurves = false;
+		settings->animCodec = false;
+		settings->sampleAnimations = false;
+		settings->splitAnimations = false;
+		settings->animChunkTime = 1000.f;
 		settings->outType = FILETYPE_AUTO;
 		settings->inType = FILETYPE_AUTO;
 
 		for (int i = 1; i < argc; i++) {
 			const char *arg = argv[i];
 			const int len = (int)strlen(arg);
-			if (len > 1 && arg[0] == '-') {
+			if (len > 2 && arg[0] == '-' && arg[1] == '-') {
+				if ((strcmp(arg, "--index-width") == 0) && (i + 1 < argc))
+					settings->indexWidth = parseIndexWidth(argv[++i]);
+				else if ((strcmp(arg, "--pack") == 0) && (i + 1 < argc))
+					settings->packMode = parsePackMode(argv[++i]);
+				else if (strcmp(arg, "--static-batch") == 0)
+					settings->staticBatch = true;
+				else if ((strcmp(arg, "--preserve-nodes") == 0) && (i + 1 < argc))
+					settings->preserveNodesFile = argv[++i];
+				else if (strcmp(arg, "--quantize-positions") == 0)
+					settings->quantizePositions = true;
+				else if ((strcmp(arg, "--octahedral") == 0) && (i + 1 < argc))
+					settings->octahedralBits = atoi(argv[++i]);
+				else if ((strcmp(arg, "--uv-format") == 0) && (i + 1 < argc))
+					settings->uvFormat = parseUVFormat(argv[++i]);
+				else if ((strcmp(arg, "--blend-weights") == 0) && (i + 1 < argc))
+					settings->blendWeightBits = atoi(argv[++i]);
+				else if (strcmp(arg, "--qtangents") == 0)
+					settings->qtangents = true;
+				else if ((strcmp(arg, "--vertex-format") == 0) && (i + 1 < argc))
+					parseVertexFormat(argv[++i]);
+				else if (strcmp(arg, "--reduce-attributes") == 0)
+					settings->reduceAttributes = true;
+				else if (strcmp(arg, "--index-codec") == 0)
+					settings->indexCodec = true;
+				else if (strcmp(arg, "--vertex-codec") == 0)
+					settings->vertexCodec = true;
+				else if (strcmp(arg, "--compress") == 0)
+					settings->compressBlocks = true;
+				else if ((strcmp(arg, "--block-size") == 0) && (i + 1 < argc))
+					settings->blockSize = atoi(argv[++i]);
+				else if ((strcmp(arg, "--threads") == 0) && (i + 1 < argc))
+					settings->threads = atoi(argv[++i]);
+				else if ((strcmp(arg, "--anim-tolerance") == 0) && (i + 1 < argc))
+					settings->animTolerance = (float)atof(argv[++i]);
+				else if ((strcmp(arg, "--anim-angle") == 0) && (i + 1 < argc))
+					settings->animAngleTolerance = (float)atof(argv[++i]);
+				else if (strcmp(arg, "--anim-curves") == 0)
+					settings->animCurves = true;
+				else if (strcmp(arg, "--anim-codec") == 0)
+					settings->animCodec = true;
+				else if (strcmp(arg, "--sample-animations") == 0)
+					settings->sampleAnimations = true;
+				else if ((strcmp(arg, "--clips") == 0) && (i + 1 < argc))
+					settings->clipsFile = argv[++i];
+				else if (strcmp(arg, "--split-animations") == 0)
+					settings->splitAnimations = true;
+				else if ((strcmp(arg, "--anim-chunk") == 0) && (i + 1 < argc))
+					settings->animChunkTime = (float)atof(argv[++i]);
+				else
+					log->error(error = log::eCommandLineUnknownOption, arg);
+			}
+			else if (len > 1 && arg[0] == '-') {
 				if (arg[1] == '?')
 					help = true;
 				else if (arg[1] == 'f')
@@ -110,6 +184,52 @@ struct FbxConvCommand {
 		printf("-w <size>: The maximum amount of bone weights per vertex (default: 4)\n");
 		printf("-v       : Verbose: print additional progress information\n");
 		printf("\n");
+		printf("--index-width <bits> : The size of the indices: 16, 32 or auto (default: 16).\n");
+		printf("                       Using 32 or auto allows -m to exceed 32k.\n");
+		printf("--pack <mode>        : How to merge meshes: none (first fit), hierarchy or spatial\n");
+		printf("                       (default: none).\n");
+		printf("--static-batch       : Bake the transform of nodes that aren't animated and merge\n");
+		printf("                       their parts per material.\n");
+		printf("--preserve-nodes <file>: File with the ids of the nodes (one per line) to keep\n");
+		printf("                       when using --static-batch.\n");
+		printf("--quantize-positions : Store positions as 16-bit integers relative to the mesh bounds.\n");
+		printf("--octahedral <bits>  : Store normals, tangents and binormals octahedral encoded\n");
+		printf("                       using 8 or 16 bits per component.\n");
+		printf("--uv-format <format> : How to store texture coordinates: float, unorm16 (relative\n");
+		printf("                       to the bounds of each part) or half (default: float).\n");
+		printf("--blend-weights <bits>: Store blend weights as 8 or 16-bit normalized integers and\n");
+		printf("                       blend indices as bytes (requires -b 256 or less).\n");
+		printf("--qtangents          : Store the normal, tangent and binormal of meshes with tangents\n");
+		printf("                       as a quaternion (QTANGENT) of four 16-bit components.\n");
+		printf("--vertex-format <attr>=<type>[,...]: The component type of vertex attributes, e.g.\n");
+		printf("                       POSITION=float16,TEXCOORD=unorm16. <type> is float32, float16,\n");
+		printf("                       snorm16, unorm16, int16, uint16, snorm8, unorm8, int8, uint8,\n");
+		printf("                       oct16 or oct8. TEXCOORD applies to all texture coordinates.\n");
+		printf("--reduce-attributes  : Remove constant vertex colors, binormals that can be calculated\n");
+		printf("                       from the normal and tangent and unused texture coordinates.\n");
+		printf("--index-codec        : Compress the indices using triangle adjacency (c3db only).\n");
+		printf("--vertex-codec       : Compress the vertices using byte wise deltas (c3db only).\n");
+		printf("--compress           : Store the c3db file as independently zlib compressed blocks.\n");
+		printf("--block-size <size>  : The size in KB of the compressed blocks (default: 256).\n");
+		printf("--threads <count>    : The number of threads to use (default: number of cores).\n");
+		printf("--anim-tolerance <distance>: Remove the animation keys of each channel that can be\n");
+		printf("                       interpolated while nodes deviate at most <distance> units.\n");
+		printf("--anim-angle <degrees>: The maximum angle nodes may deviate when using\n");
+		printf("                       --anim-tolerance (default: 0.5).\n");
+		printf("--anim-curves        : Store the animations reduced by --anim-tolerance as cubic\n");
+		printf("                       Hermite curves (keyframes with tangents).\n");
+		printf("--anim-codec         : Store the keyframes as quantized tracks (c3db only).\n");
+		printf("--sample-animations  : Always sample the animations at their frame rate, instead of\n");
+		printf("                       using the key times of the curves where the keyframes at those\n");
+		printf("                       reproduce the curves.\n");
+		printf("                       Implied by --anim-codec.\n");
+		printf("--clips <file>       : Split the animation takes into the clips defined by the file, each\n");
+		printf("                       line: <name> <start frame> <end frame> [loop], the clips apply\n");
+		printf("                       to the first take or to the take of the last 'take <name>' line.\n");
+		printf("--split-animations   : Write the animations to a separate bank file (<output>.c3ab),\n");
+		printf("                       split into chunks which can be loaded independently.\n");
+		printf("--anim-chunk <ms>    : The duration of the chunks of the animation bank (default: 1000).\n");
+		printf("\n");
 		printf("<input>  : The filename of the file to convert.\n");
 		printf("<output> : The filename of the converted file.\n");
 		printf("\n");
@@ -135,6 +255,42 @@ private:
         }
         else if (settings->outType == FILETYPE_AUTO)
 			settings->outType = guessType(settings->outFile);
+		if (settings->indexCodec && settings->outType != FILETYPE_G3DB) {
+			log->error(error = log::eCommandLineIndexCodecRequiresBinary);
+			return;
+		}
+		if (settings->vertexCodec && settings->outType != FILETYPE_G3DB) {
+			log->error(error = log::eCommandLineVertexCodecRequiresBinary);
+			return;
+		}
+		if (settings->animCodec && settings->outType != FILETYPE_G3DB) {
+			log->error(error = log::eCommandLineAnimCodecRequiresBinary);
+			return;
+		}
+		if (settings->compressBlocks && settings->outType != FILETYPE_G3DB) {
+			log->error(error = log::eCommandLineCompressRequiresBinary);
+			return;
+		}
+		if (settings->blockSize <= 0 || settings->blockSize > (1<<20)) {
+			log->error(error = log::eCommandLineInvalidBlockSize);
+			return;
+		}
+		if (settings->threads < 0) {
+			log->error(error = log::eCommandLineInvalidThreadCount);
+			return;
+		}
+		if (settings->animTolerance < 0.f || settings->animAngleTolerance < 0.f) {
+			log->error(error = log::eCommandLineInvalidAnimTolerance);
+			return;
+		}
+		if (settings->animCurves && settings->animTolerance <= 0.f) {
+			log->error(error = log::eCommandLineAnimCurvesRequiresTolerance);
+			return;
+		}
+		if (!(settings->animChunkTime > 0.f)) {
+			log->error(error = log::eCommandLineInvalidAnimChunk);
+			return;
+		}
 		if (settings->maxVertexBonesCount < 0 || settings->maxVertexBonesCount > 8) {
 			log->error(error = log::eCommandLineInvalidVertexWeight);
 			return;
@@ -143,7 +299,19 @@ private:
 			log->error(error = log::eCommandLineInvalidBoneCount);
 			return;
 		}
-		if (settings->maxVertexCount < 0 || settings->maxVertexCount > (1<<15)-1) {
+		if (settings->octahedralBits != 0 && settings->octahedralBits != 8 && settings->octahedralBits != 16) {
+			log->error(error = log::eCommandLineInvalidOctahedralBits);
+			return;
+		}
+		if (settings->blendWeightBits != 0 && settings->blendWeightBits != 8 && settings->blendWeightBits != 16) {
+			log->error(error = log::eCommandLineInvalidBlendWeightBits);
+			return;
+		}
+		if (settings->blendWeightBits != 0 && settings->maxNodePartBonesCount > 256) {
+			log->error(error = log::eCommandLineInvalidBlendBoneCount);
+			return;
+		}
+		if (settings->maxVertexCount < 0 || (settings->indexWidth == INDEXWIDTH_16 && settings->maxVertexCount > INDEXWIDTH_16_MAX)) {
 			log->error(error = log::eCommandLineInvalidVertexCount);
 			return;
 		}
@@ -161,6 +329,92 @@ private:
 		return def;
 	}
 
+	int parseIndexWidth(const char* arg) {
+		if (stricmp(arg, "auto")==0)
+			return INDEXWIDTH_AUTO;
+		const int bits = atoi(arg);
+		if (bits == INDEXWIDTH_16 || bits == INDEXWIDTH_32)
+			return bits;
+		log->error(error = log::eCommandLineInvalidIndexWidth);
+		return -1;
+	}
+
+	int parsePackMode(const char* arg) {
+		if (stricmp(arg, "none")==0)
+			return PACKMODE_NONE;
+		else if (stricmp(arg, "hierarchy")==0)
+			return PACKMODE_HIERARCHY;
+		else if (stricmp(arg, "spatial")==0)
+			return PACKMODE_SPATIAL;
+		log->error(error = log::eCommandLineInvalidPackMode);
+		return -1;
+	}
+
+	int parseUVFormat(const char* arg) {
+		if (stricmp(arg, "float")==0)
+			return UVFORMAT_FLOAT;
+		else if (stricmp(arg, "unorm16")==0)
+			return UVFORMAT_UNORM16;
+		else if (stricmp(arg, "half")==0)
+			return UVFORMAT_HALF;
+		log->error(error = log::eCommandLineInvalidUVFormat);
+		return -1;
+	}
+
+	/** The component type with the specified name (e.g. "unorm16"), or -1 if unknown */
+	static int parseTypeName(const char* arg) {
+		for (unsigned int i = 0; i < sizeof(modeldata::AttributeTypeNames) / sizeof(*modeldata::AttributeTypeNames); i++)
+			if (stricmp(arg, modeldata::AttributeTypeNames[i].name)==0)
+				return modeldata::AttributeTypeNames[i].type;
+		return -1;
+	}
+
+	/** Parse a comma separated list of ATTRIBUTE=type pairs into settings->vertexFormat */
+	void parseVertexFormat(const char* arg) {
+		std::string format(arg);
+		for (std::string::size_type start = 0; start <= format.length() && error == log::iNoError; ) {
+			std::string::size_type end = format.find(',', start);
+			if (end == std::string::npos)
+				end = format.length();
+			const std::string item = format.substr(start, end - start);
+			start = end + 1;
+			const std::string::size_type eq = item.find('=');
+			const int type = eq == std::string::npos ? -1 : parseTypeName(item.substr(eq + 1).c_str());
+			const std::string name = eq == std::string::npos ? item : item.substr(0, eq);
+			int first = -1, last = -1;
+			if (stricmp(name.c_str(), "TEXCOORD") == 0) {
+				first = ATTRIBUTE_TEXCOORD0;
+				last = ATTRIBUTE_TEXCOORD7;
+			}
+			else {
+				for (int a = 0; a < ATTRIBUTE_COUNT; a++)
+					if (stricmp(name.c_str(), modeldata::AttributeNames[a]) == 0)
+						first = last = a;
+			}
+			if (type < 0 || first <= ATTRIBUTE_UNKNOWN || !isValidVertexFormat(first, type)) {
+				log->error(error = log::eCommandLineInvalidVertexFormat, item.c_str());
+				return;
+			}
+			for (int a = first; a <= last; a++)
+				settings->vertexFormat.push_back(std::make_pair(a, type));
+		}
+	}
+
+	static bool isValidVertexFormat(const int &attribute, const int &type) {
+		if ((type & ATTRIBUTE_TYPE_OCTAHEDRAL) && attribute != ATTRIBUTE_NORMAL && attribute != ATTRIBUTE_TANGENT && attribute != ATTRIBUTE_BINORMAL)
+			return false;
+		// Packed colors already are four bytes
+		if (attribute == ATTRIBUTE_COLORPACKED)
+			return type == ATTRIBUTE_TYPE_FLOAT;
+		// Normalized blend weights are quantized to sum up to the maximum unsigned value
+		if (attribute == ATTRIBUTE_BLENDWEIGHT && (type & ATTRIBUTE_TYPE_NORMALIZED))
+			return (type & ATTRIBUTE_TYPE_UNSIGNED) != 0;
+		// The handedness is stored in the sign of w, which is kept away from zero by QTANGENT_BIAS (that rounds to zero using 8 bits)
+		if (attribute == ATTRIBUTE_QTANGENT)
+			return type == ATTRIBUTE_TYPE_FLOAT || type == ATTRIBUTE_TYPE_HALF || type == ATTRIBUTE_TYPE_SNORM16;
+		return true;
+	}
+
 	int guessType(const std::string &fn, const int &def = -1) {
 		int o = (int)fn.find_last_of('.');
 		if (o == std::string::npos)
@@ -21,6 +21,7 @@
 #define SETTINGS_H
 
 #include <string>
+#include <vector>
 
 namespace fbxconv {
 
@@ -31,6 +32,20 @@ namespace fbxconv {
 #define FILETYPE_OUT_DEFAULT	FILETYPE_G3DJ
 #define FILETYPE_IN_DEFAULT		FILETYPE_FBX
 
+#define INDEXWIDTH_AUTO			0
+#define INDEXWIDTH_16			16
+#define INDEXWIDTH_32			32
+// The maximum amount of vertices of a mesh with 16-bit indices, the binary writer stores the indices as signed 16-bit integers
+#define INDEXWIDTH_16_MAX		((1<<15)-1)
+
+#define PACKMODE_NONE			0
+#define PACKMODE_HIERARCHY		1
+#define PACKMODE_SPATIAL		2
+
+#define UVFORMAT_FLOAT			0
+#define UVFORMAT_UNORM16		1
+#define UVFORMAT_HALF			2
+
 struct Settings {
 	std::string inFile;
 	int inType;
@@ -51,6 +66,55 @@ struct Settings {
 	int maxVertexCount;
 	/** The maximum allowed amount of indices in one mesh, only used when deciding to merge meshes. */
 	int maxIndexCount;
+	/** The size in bits of the indices (INDEXWIDTH_16 or INDEXWIDTH_32), or INDEXWIDTH_AUTO to use the smallest size per mesh. */
+	int indexWidth;
+	/** How to merge meshes: PACKMODE_NONE (first fit), PACKMODE_HIERARCHY or PACKMODE_SPATIAL (fewest meshes, keeping nearby meshes together). */
+	int packMode;
+	/** Whether to bake the transform of nodes which aren't animated into the vertices and merge their parts per material. */
+	bool staticBatch;
+	/** The file listing the ids (one per line) of the nodes that must not be merged by static batching. */
+	std::string preserveNodesFile;
+	/** Whether to store positions as 16-bit normalized integers relative to the bounds of the mesh. */
+	bool quantizePositions;
+	/** The number of bits (8 or 16) per component to store normals, tangents and binormals octahedral encoded, or 0 to store them as floats. */
+	int octahedralBits;
+	/** How to store texture coordinates: UVFORMAT_FLOAT, UVFORMAT_UNORM16 (relative to the bounds of each part) or UVFORMAT_HALF. */
+	int uvFormat;
+	/** The number of bits (8 or 16) per blend weight to store the blend weights as normalized integers and the blend indices as bytes, or 0 to store them as floats. */
+	int blendWeightBits;
+	/** Whether to store the normal, tangent and binormal of normal mapped meshes as a single quaternion (QTangent). */
+	bool qtangents;
+	/** The component type (ATTRIBUTE_TYPE_XXX) per attribute (ATTRIBUTE_XXX), overriding the other vertex encoding options. */
+	std::vector<std::pair<int, int> > vertexFormat;
+	/** Whether to remove constant vertex colors, binormals that can be calculated from the normal and tangent and unused texture coordinates. */
+	bool reduceAttributes;
+	/** Whether to compress the indices of triangle mesh parts with the index codec (c3db only). */
+	bool indexCodec;
+	/** Whether to compress the vertices with the vertex codec (c3db only). */
+	bool vertexCodec;
+	/** Whether to wrap the c3db file in a container of independently (zlib) compressed blocks. */
+	bool compressBlocks;
+	/** The size in KB of the uncompressed blocks. */
+	int blockSize;
+	/** The number of threads to use, or 0 to use the number of cores. */
+	int threads;
+	/** The maximum distance (in scene units) animated nodes may deviate when reducing keyframes, or 0 to only remove redundant keyframes. */
+	float animTolerance;
+	/** The maximum angle (in degrees) animated nodes may deviate when reducing keyframes. */
+	float animAngleTolerance;
+	/** Whether to store the reduced animations as cubic Hermite curves (keyframes with tangents) instead of linear keyframes. */
+	bool animCurves;
+	/** Whether to store the keyframes as quantized tracks with the track codec (c3db only). */
+	bool animCodec;
+	/** Whether to always sample the animations at their frame rate, instead of using the key times of the curves where the keyframes at those reproduce the curves.
+	 * Animations are always sampled at their frame rate when using animCodec. */
+	bool sampleAnimations;
+	/** The file which defines the clips to split the animation takes into, or empty to convert each take as one animation. */
+	std::string clipsFile;
+	/** Whether to write the animations to a separate animation bank file (see AnimationBank) instead of the model file. */
+	bool splitAnimations;
+	/** The duration (in milliseconds) of the chunks the animations are split into in the animation bank file. */
+	float animChunkTime;
 };
 
 }
@@ -197,6 +197,8 @@ protected:
 	virtual void writeValue(const unsigned int &value, const bool &iskey = false) = 0;
 	virtual void writeValue(const unsigned long &value, const bool &iskey = false) = 0;
 	// If writeOpenXXXData returns false, it falls back on writing out an array
+	inline virtual bool writeOpenCharData(const size_t& count) { return false; }
+	inline virtual bool writeOpenUCharData(const size_t& count) { return false; }
 	inline virtual bool writeOpenFloatData(const size_t& count) { return false; }
 	inline virtual bool writeOpenDoubleData(const size_t& count) { return false; }
 	inline virtual bool writeOpenShortData(const size_t& count) { return false; }
@@ -205,6 +207,8 @@ protected:
 	inline virtual bool writeOpenUIntData(const size_t& count) { return false; }
 	inline virtual bool writeOpenLongData(const size_t& count) { return false; }
 	inline virtual bool writeOpenULongData(const size_t& count) { return false; }
+	inline virtual void writeCharData(const char * const &values, const size_t &count) {}
+	inline virtual void writeUCharData(const unsigned char * const &values, const size_t &count) {}
 	inline virtual void writeFloatData(const float * const &values, const size_t &count) {}
 	inline virtual void writeDoubleData(const double * const &values, const size_t &count) {}
 	inline virtual void writeShortData(const short * const &values, const size_t &count) {}
@@ -227,6 +231,8 @@ private:
 	}
 
 	template<class T> inline bool openData(const T &dummy, const size_t &items) { return false; }
+	inline bool openData(const char &dummy, const size_t &items) { return writeOpenCharData(items); }
+	inline bool openData(const unsigned char &dummy, const size_t &items) { return writeOpenUCharData(items); }
 	inline bool openData(const float &dummy, const size_t &items) { return writeOpenFloatData(items); }
 	inline bool openData(const double &dummy, const size_t &items) { return writeOpenDoubleData(items); }
 	inline bool openData(const short &dummy, const size_t &items) { return writeOpenShortData(items); }
@@ -236,6 +242,8 @@ private:
 	inline bool openData(const long &dummy, const size_t &items) { return writeOpenLongData(items); }
 	inline bool openData(const unsigned long &dummy, const size_t &items) { return writeOpenULongData(items); }
 	template<class T> inline void dataItem(const T * const &value, const size_t &count) {}
+	inline void dataItem(const char * const &value, const size_t &count) { writeCharData(value, count); }
+	inline void dataItem(const unsigned char * const &value, const size_t &count) { writeUCharData(value, count); }
 	inline void dataItem(const float * const &value, const size_t &count) { writeFloatData(value, count); }
 	inline void dataItem(const double * const &value, const size_t &count) { writeDoubleData(value, count); }
 	inline void dataItem(const short * const &value, const size_t &count) { writeShortData(value, count); }
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * Copyright 2011 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+/** @author Xoppa */
+#ifdef _MSC_VER
+#pragma once
+#endif
+#ifndef JSON_BLOCKCOMPRESSOR_H
+#define JSON_BLOCKCOMPRESSOR_H
+
+#include <string>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <ostream>
+#include <thread>
+#include <atomic>
+#include <zlib.h>
+
+#define BLOCKCOMPRESSOR_MAGIC		"C3BZ"
+#define BLOCKCOMPRESSOR_VERSION		1
+#define BLOCKCOMPRESSOR_CODEC_ZLIB	1
+
+namespace json {
+
+/** Wraps a serialized stream in a container of independently compressed blocks, so the blocks can be compressed and
+ * decompressed in parallel. All numbers are big endian (like UBJSON):
+ *   char[4] magic ("C3BZ"), uint32 version, uint32 codec (1: zlib), uint32 block size, uint32 block count, uint64 total size,
+ *   for each block: uint64 offset (from the start of the container), uint32 compressed size, uint32 uncompressed size,
+ *   followed by the compressed blocks. */
+class BlockCompressor {
+public:
+	struct Block {
+		std::vector<unsigned char> data;
+		unsigned long long offset;
+		unsigned int packedSize;
+		unsigned int size;
+		bool valid;
+	};
+
+	/** Compress the data using the specified amount of threads (0 for the number of cores) and write the container to the stream */
+	static bool write(std::ostream &stream, const std::string &data, const unsigned int &blockSize, const unsigned int &threadCount, const int &level = Z_BEST_COMPRESSION) {
+		const unsigned int blockCount = (unsigned int)((data.size() + blockSize - 1) / blockSize);
+		std::vector<Block> blocks(blockCount);
+		forEach(blockCount, threadCount, [&](const unsigned int &i) {
+			Block &block = blocks[i];
+			block.size = (unsigned int)std::min((size_t)blockSize, data.size() - (size_t)i * blockSize);
+			uLongf size = compressBound(block.size);
+			block.data.resize(size);
+			block.valid = compress2(&block.data[0], &size, (const Bytef *)&data[(size_t)i * blockSize], block.size, level) == Z_OK;
+			block.data.resize(size);
+		});
+
+		std::vector<unsigned char> header;
+		header.insert(header.end(), BLOCKCOMPRESSOR_MAGIC, BLOCKCOMPRESSOR_MAGIC + 4);
+		writeInt(header, BLOCKCOMPRESSOR_VERSION, 4);
+		writeInt(header, BLOCKCOMPRESSOR_CODEC_ZLIB, 4);
+		writeInt(header, blockSize, 4);
+		writeInt(header, blockCount, 4);
+		writeInt(header, data.size(), 8);
+		unsigned long long offset = header.size() + blockCount * 16ULL;
+		for (std::vector<Block>::iterator itr = blocks.begin(); itr != blocks.end(); ++itr) {
+			if (!(*itr).valid)
+				return false;
+			writeInt(header, offset, 8);
+			writeInt(header, (*itr).data.size(), 4);
+			writeInt(header, (*itr).size, 4);
+			offset += (*itr).data.size();
+		}
+		stream.write((const char *)&header[0], header.size());
+		for (std::vector<Block>::iterator itr = blocks.begin(); itr != blocks.end(); ++itr)
+			stream.write((const char *)&(*itr).data[0], (*itr).data.size());
+		return stream.good();
+	}
+
+	/** Decompress the container using the specified amount of threads (0 for the number of cores), returns false if the data is malformed.
+	 * This is the reference reader for the c3db block container. */
+	static bool read(const unsigned char * const &data, const unsigned long long &size, std::string &out, const unsigned int &threadCount) {
+		if (size < 28 || memcmp(data, BLOCKCOMPRESSOR_MAGIC, 4) != 0 || readInt(&data[4], 4) != BLOCKCOMPRESSOR_VERSION || readInt(&data[8], 4) != BLOCKCOMPRESSOR_CODEC_ZLIB)
+			return false;
+		const unsigned long long blockSize = readInt(&data[12], 4), blockCount = readInt(&data[16], 4), total = readInt(&data[20], 8);
+		if (size < 28 + blockCount * 16 || blockCount * blockSize < total)
+			return false;
+		// Validate the whole table before allocating the output or starting any threads: the blocks must follow each other
+		// within the container and every block but the last must decompress to exactly the block size.
+		std::vector<Block> blocks((size_t)blockCount);
+		unsigned long long end = 28 + blockCount * 16;
+		for (unsigned int i = 0; i < blockCount; i++) {
+			const unsigned char * const entry = &data[28 + i * 16];
+			blocks[i].offset = readInt(entry, 8);
+			blocks[i].packedSize = (unsigned int)readInt(&entry[8], 4);
+			blocks[i].size = (unsigned int)readInt(&entry[12], 4);
+			if (blocks[i].offset < end || blocks[i].offset > size || blocks[i].packedSize > size - blocks[i].offset)
+				return false;
+			if (i + 1 < blockCount ? blocks[i].size != blockSize : i * blockSize + blocks[i].size != total)
+				return false;
+			end = blocks[i].offset + blocks[i].packedSize;
+		}
+		out.resize((size_t)total);
+		std::atomic<bool> valid(true);
+		forEach((unsigned int)blockCount, threadCount, [&](const unsigned int &i) {
+			uLongf length = blocks[i].size;
+			if (uncompress((Bytef *)&out[(size_t)(i * blockSize)], &length, &data[blocks[i].offset], (uLong)blocks[i].packedSize) != Z_OK || length != blocks[i].size)
+				valid = false;
+		});
+		return valid;
+	}
+
+	/** Call the function for each index 0..count-1, distributed over the specified amount of threads (0 for the number of cores) */
+	template<class F> static void forEach(const unsigned int &count, const unsigned int &threadCount, const F &function) {
+		unsigned int n = threadCount > 0 ? threadCount : std::thread::hardware_concurrency();
+		n = std::max(1U, std::min(n, count));
+		std::atomic<unsigned int> next(0);
+		std::vector<std::thread> threads;
+		for (unsigned int t = 1; t < n; t++)
+			threads.push_back(std::thread([&]() {
+				for (unsigned int i = next++; i < count; i = next++)
+					function(i);
+			}));
+		for (unsigned int i = next++; i < count; i = next++)
+			function(i);
+		for (std::vector<std::thread>::iterator itr = threads.begin(); itr != threads.end(); ++itr)
+			(*itr).join();
+	}
+
+private:
+	static inline void writeInt(std::vector<unsigned char> &out, const unsigned long long &value, const int &bytes) {
+		for (int i = bytes - 1; i >= 0; i--)
+			out.push_back((unsigned char)(value >> (8 * i)));
+	}
+
+	static inline unsigned long long readInt(const unsigned char * const &data, const int &bytes) {
+		unsigned long long result = 0;
+		for (int i = 0; i < bytes; i++)
+			result = (result << 8) | data[i];
+		return result;
+	}
+};
+}
+
+#endif //JSON_BLOCKCOMPRESSOR_H
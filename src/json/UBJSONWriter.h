@@ -131,6 +131,8 @@ protected:
 			write(values[i]);
 	}
 
+	inline virtual bool writeOpenCharData(const size_t& count) { return writeOpenData("B", count); }
+	inline virtual bool writeOpenUCharData(const size_t& count) { return writeOpenData("B", count); }
 	inline virtual bool writeOpenFloatData(const size_t& count) { return writeOpenData("d", count); }
 	inline virtual bool writeOpenDoubleData(const size_t& count) { return writeOpenData("D", count); }
 	inline virtual bool writeOpenShortData(const size_t& count) { return writeOpenData("i", count); }
@@ -140,6 +142,8 @@ protected:
 	inline virtual bool writeOpenLongData(const size_t& count) { return writeOpenData("L", count); }
 	inline virtual bool writeOpenULongData(const size_t& count) { return writeOpenData("L", count); }
 
+	inline virtual void writeCharData(const char * const &values, const size_t &count) { stream.write(values, count); }
+	inline virtual void writeUCharData(const unsigned char * const &values, const size_t &count) { stream.write((const char *)values, count); }
 	inline virtual void writeFloatData(const float * const &values, const size_t &count) { writeData(values, count); }
 	inline virtual void writeDoubleData(const double * const &values, const size_t &count) {writeData(values, count); }
 	inline virtual void writeShortData(const short * const &values, const size_t &count) {writeData(values, count); }
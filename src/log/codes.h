@@ -37,6 +37,22 @@ LOG_ADD_CODE(eCommandLineMissingInputFile)
 LOG_ADD_CODE(eCommandLineInvalidVertexWeight)
 LOG_ADD_CODE(eCommandLineInvalidBoneCount)
 LOG_ADD_CODE(eCommandLineInvalidVertexCount)
+LOG_ADD_CODE(eCommandLineInvalidIndexWidth)
+LOG_ADD_CODE(eCommandLineInvalidPackMode)
+LOG_ADD_CODE(eCommandLineInvalidOctahedralBits)
+LOG_ADD_CODE(eCommandLineInvalidUVFormat)
+LOG_ADD_CODE(eCommandLineInvalidBlendWeightBits)
+LOG_ADD_CODE(eCommandLineInvalidBlendBoneCount)
+LOG_ADD_CODE(eCommandLineInvalidVertexFormat)
+LOG_ADD_CODE(eCommandLineIndexCodecRequiresBinary)
+LOG_ADD_CODE(eCommandLineVertexCodecRequiresBinary)
+LOG_ADD_CODE(eCommandLineAnimCodecRequiresBinary)
+LOG_ADD_CODE(eCommandLineCompressRequiresBinary)
+LOG_ADD_CODE(eCommandLineInvalidBlockSize)
+LOG_ADD_CODE(eCommandLineInvalidThreadCount)
+LOG_ADD_CODE(eCommandLineInvalidAnimTolerance)
+LOG_ADD_CODE(eCommandLineAnimCurvesRequiresTolerance)
+LOG_ADD_CODE(eCommandLineInvalidAnimChunk)
 LOG_ADD_CODE(eCommandLineUnknownFiletype)
 
 LOG_ADD_CODE(sSourceLoad)
@@ -54,7 +70,7 @@ LOG_ADD_CODE(wSourceConvertFbxInvalidBone)
 LOG_ADD_CODE(wSourceConvertFbxAdditiveBones)
 LOG_ADD_CODE(wSourceConvertFbxCantTriangulate)
 LOG_ADD_CODE(wSourceConvertFbxNoPolyPart)
-LOG_ADD_CODE(wSourceConvertFbxExceedsIndices)
+LOG_ADD_CODE(iSourceConvertFbxSplitMesh)
 LOG_ADD_CODE(wSourceConvertFbxExceedsBones)
 LOG_ADD_CODE(wSourceConvertFbxZeroWeights)
 LOG_ADD_CODE(wSourceConvertFbxDuplicateMesh)
@@ -68,6 +84,34 @@ LOG_ADD_CODE(wSourceConvertFbxMaterialCgFX)
 LOG_ADD_CODE(wSourceConvertFbxLayeredTexture)
 LOG_ADD_CODE(wSourceConvertFbxSkipPropname)
 LOG_ADD_CODE(wSourceConvertFbxInvalidMesh)
+LOG_ADD_CODE(iSourceConvertIndexWidth)
+LOG_ADD_CODE(wSourceConvertExceedsIndexWidth)
+LOG_ADD_CODE(iSourceConvertMeshUtilization)
+LOG_ADD_CODE(iSourceConvertMeshPacking)
+LOG_ADD_CODE(eSourceConvertPreserveNodes)
+LOG_ADD_CODE(eSourceConvertClips)
+LOG_ADD_CODE(eSourceConvertClipsLine)
+LOG_ADD_CODE(eSourceConvertClipsTake)
+LOG_ADD_CODE(wSourceConvertClipsEmpty)
+LOG_ADD_CODE(iSourceConvertStaticBatch)
+LOG_ADD_CODE(iSourceConvertFbxInstance)
+LOG_ADD_CODE(iSourceConvertReduceAttributes)
+LOG_ADD_CODE(iSourceConvertReduceKeyframes)
+LOG_ADD_CODE(iSourceConvertEncodeMesh)
+LOG_ADD_CODE(iSourceConvertEncodeError)
+LOG_ADD_CODE(wSourceConvertEncodeUVVertices)
+LOG_ADD_CODE(iSourceConvertEncodeSummary)
+LOG_ADD_CODE(iSourceConvertEncodeSummaryError)
+LOG_ADD_CODE(wSourceConvertEncodeIndices)
+LOG_ADD_CODE(wSourceConvertIndexCodecTest)
+LOG_ADD_CODE(iSourceConvertEncodeIndices)
+LOG_ADD_CODE(wSourceConvertCompressVertices)
+LOG_ADD_CODE(iSourceConvertCompressVertices)
+LOG_ADD_CODE(wSourceConvertEncodeAnimation)
+LOG_ADD_CODE(iSourceConvertEncodeAnimations)
+LOG_ADD_CODE(wSourceConvertSampleAnimations)
+LOG_ADD_CODE(iSourceConvertSampleAnimations)
+LOG_ADD_CODE(iSourceConvertKeyedAnimations)
 LOG_ADD_CODE(eSourceConvert)
 
 LOG_ADD_CODE(sSourceClose)
@@ -77,6 +121,10 @@ LOG_ADD_CODE(sExportToG3DB)
 LOG_ADD_CODE(sExportToG3DJ)
 LOG_ADD_CODE(sExportClose)
 LOG_ADD_CODE(eExportFiletypeUnknown)
+LOG_ADD_CODE(iExportCompressBlocks)
+LOG_ADD_CODE(eExportCompressBlocks)
+LOG_ADD_CODE(sExportAnimationBank)
+LOG_ADD_CODE(eExportAnimationBank)
 
 LOG_ADD_CODE(iModelInfoNull)
 LOG_ADD_CODE(iModelInfoStart)
@@ -37,7 +37,23 @@ LOG_SET_MSG(eCommandLineUnknownArgument,		"Unknown command line argument: %s")
 LOG_SET_MSG(eCommandLineMissingInputFile,		"Missing input file")
 LOG_SET_MSG(eCommandLineInvalidVertexWeight,	"Maximum vertex weights must be between 0 and 8")
 LOG_SET_MSG(eCommandLineInvalidBoneCount,		"Maximum bones per nodepart must be greater or equal to the maximum vertex weights")
-LOG_SET_MSG(eCommandLineInvalidVertexCount,		"Maximum vertex count must be between 0 and 32k")
+LOG_SET_MSG(eCommandLineInvalidVertexCount,		"Maximum vertex count must be between 0 and 32k, unless 32-bit indices are allowed")
+LOG_SET_MSG(eCommandLineInvalidIndexWidth,		"Index width must be 16, 32 or auto")
+LOG_SET_MSG(eCommandLineInvalidPackMode,		"Pack mode must be none, hierarchy or spatial")
+LOG_SET_MSG(eCommandLineInvalidOctahedralBits,	"Octahedral encoding must use 8 or 16 bits")
+LOG_SET_MSG(eCommandLineInvalidUVFormat,		"UV format must be float, unorm16 or half")
+LOG_SET_MSG(eCommandLineInvalidBlendWeightBits,	"Blend weights must use 8 or 16 bits")
+LOG_SET_MSG(eCommandLineInvalidVertexFormat,		"Invalid vertex format: %s")
+LOG_SET_MSG(eCommandLineIndexCodecRequiresBinary,	"The index codec is only supported for c3db files")
+LOG_SET_MSG(eCommandLineVertexCodecRequiresBinary,	"The vertex codec is only supported for c3db files")
+LOG_SET_MSG(eCommandLineAnimCodecRequiresBinary,	"The animation codec is only supported for c3db files")
+LOG_SET_MSG(eCommandLineCompressRequiresBinary,	"Block compression is only supported for c3db files")
+LOG_SET_MSG(eCommandLineInvalidBlockSize,		"Block size must be between 1 and 1048576 KB")
+LOG_SET_MSG(eCommandLineInvalidThreadCount,		"Thread count must be 0 (number of cores) or more")
+LOG_SET_MSG(eCommandLineInvalidAnimTolerance,	"Animation tolerances must be 0 or more")
+LOG_SET_MSG(eCommandLineAnimCurvesRequiresTolerance,	"--anim-curves requires --anim-tolerance")
+LOG_SET_MSG(eCommandLineInvalidAnimChunk,		"The duration of the animation chunks must be more than 0")
+LOG_SET_MSG(eCommandLineInvalidBlendBoneCount,	"Maximum bones per nodepart must be 256 or less to store blend indices as bytes")
 LOG_SET_MSG(eCommandLineUnknownFiletype,		"Unknown filetype: %s")
 
 LOG_SET_MSG(sSourceLoad,						"Loading source file")
@@ -55,7 +71,7 @@ LOG_SET_MSG(wSourceConvertFbxInvalidBone,		"[%s] Skipping invalid bone: %s")
 LOG_SET_MSG(wSourceConvertFbxAdditiveBones,		"[%s] Additive bones not supported (yet)")
 LOG_SET_MSG(wSourceConvertFbxCantTriangulate,	"[%s] Skipping geometry, because it can't be triangulated")
 LOG_SET_MSG(wSourceConvertFbxNoPolyPart,		"[%s] No material found for polygon %d")
-LOG_SET_MSG(wSourceConvertFbxExceedsIndices,	"Mesh contains more indices (%d) than the specified maximum (%d)")
+LOG_SET_MSG(iSourceConvertFbxSplitMesh,		"[%s] Mesh contains more indices (%d) than the specified maximum (%d), splitting it into %d meshes")
 LOG_SET_MSG(wSourceConvertFbxExceedsBones,		"Mesh contains more blendweights per polygon than the specified maximum.")
 LOG_SET_MSG(wSourceConvertFbxZeroWeights,		"Mesh contains vertices with zero bone weights.")
 LOG_SET_MSG(wSourceConvertFbxDuplicateMesh,		"[%s] Skipping geometry with duplicate mesh")
@@ -69,6 +85,34 @@ LOG_SET_MSG(wSourceConvertFbxMaterialCgFX,		"[%s] Material CgFX shading not supp
 LOG_SET_MSG(wSourceConvertFbxLayeredTexture,	"[%s] Layered texture blending not supported, assuming full opacity")
 LOG_SET_MSG(wSourceConvertFbxSkipPropname,		"[%s] Skipping propName '%s'")
 LOG_SET_MSG(wSourceConvertFbxInvalidMesh,		"[%s] Skipping invalid mesh")
+LOG_SET_MSG(iSourceConvertIndexWidth,			"[%s] vertices: %d, using %d-bit indices")
+LOG_SET_MSG(wSourceConvertExceedsIndexWidth,	"[%s] Mesh contains more vertices (%d) than can be addressed with %d-bit indices")
+LOG_SET_MSG(iSourceConvertMeshUtilization,		"[%s] vertices: %d/%d (%.1f%%), indices: %d/%d (%.1f%%)")
+LOG_SET_MSG(eSourceConvertPreserveNodes,		"Unable to read the nodes to preserve from: %s")
+LOG_SET_MSG(eSourceConvertClips,				"Unable to read the clips from: %s")
+LOG_SET_MSG(eSourceConvertClipsLine,			"[%s:%d] Invalid clip, expected: <name> <start frame> <end frame> [loop]")
+LOG_SET_MSG(eSourceConvertClipsTake,			"[%s:%d] Unknown animation take: %s")
+LOG_SET_MSG(wSourceConvertClipsEmpty,			"[%s] Skipping clip, its animation take doesn't animate any nodes")
+LOG_SET_MSG(iSourceConvertStaticBatch,			"Static batching merged %d node parts of %d nodes into %d node parts, removed %d nodes")
+LOG_SET_MSG(iSourceConvertFbxInstance,			"[%s] Geometry is an instance of %s")
+LOG_SET_MSG(iSourceConvertReduceAttributes,		"[%s] Removed the vertex attributes %s: %d -> %d bytes")
+LOG_SET_MSG(iSourceConvertReduceKeyframes,		"[%s] Reduced the animation keys: %d -> %d")
+LOG_SET_MSG(iSourceConvertEncodeMesh,			"[%s] vertex size: %d -> %d bytes")
+LOG_SET_MSG(iSourceConvertEncodeError,			"[%s] %s maximum error: %g%s")
+LOG_SET_MSG(wSourceConvertEncodeUVVertices,		"[%s] Quantizing the texture coordinates per part requires more than %d vertices, using half floats instead")
+LOG_SET_MSG(iSourceConvertEncodeSummary,		"Encoded %d meshes, vertex data: %d -> %d bytes")
+LOG_SET_MSG(iSourceConvertEncodeSummaryError,	"%s maximum error: %g%s")
+LOG_SET_MSG(wSourceConvertEncodeIndices,			"[%s] The encoded indices don't match the original indices, storing them uncompressed")
+LOG_SET_MSG(wSourceConvertIndexCodecTest,			"The index codec failed its round trip test, storing the indices uncompressed")
+LOG_SET_MSG(wSourceConvertCompressVertices,		"[%s] The decompressed vertices don't match the original vertices, storing them uncompressed")
+LOG_SET_MSG(iSourceConvertCompressVertices,		"Compressed the vertices of %d meshes: %d -> %d bytes (%.2fx), reference decoder: %.0f MB/s")
+LOG_SET_MSG(wSourceConvertEncodeAnimation,		"[%s] The decoded keyframes of %s don't match the original keyframes, storing them unencoded")
+LOG_SET_MSG(iSourceConvertEncodeAnimations,		"Encoded the keyframes of %d node animations: %d -> %d bytes, max error: translation %g, rotation %g degrees, scale %g, time %g ms")
+LOG_SET_MSG(wSourceConvertSampleAnimations,		"%d threads failed to import a copy of the scene, the other threads sampled their animations")
+LOG_SET_MSG(iSourceConvertSampleAnimations,		"Sampled %d node animations (%d samples) using %d threads")
+LOG_SET_MSG(iSourceConvertKeyedAnimations,		"Used the key times of the curves for %d of %d node animations")
+LOG_SET_MSG(iSourceConvertEncodeIndices,			"Encoded the indices of %d parts: %d -> %d bytes")
+LOG_SET_MSG(iSourceConvertMeshPacking,			"Merged %d source meshes into %d meshes (lower bound %d), average utilization vertices: %.1f%%, indices: %.1f%%")
 LOG_SET_MSG(eSourceConvert,						"Error converting source file")
 
 LOG_SET_MSG(sSourceClose,						"Closing source file")
@@ -78,6 +122,10 @@ LOG_SET_MSG(sExportToG3DB,						"Exporting to G3DB file: %s")
 LOG_SET_MSG(sExportToG3DJ,						"Exporting to G3DJ file: %s")
 LOG_SET_MSG(sExportClose,						"Closing exported file")
 LOG_SET_MSG(eExportFiletypeUnknown,				"Unknown target filetype")
+LOG_SET_MSG(iExportCompressBlocks,				"Compressed %d blocks on %d threads: %d -> %d bytes")
+LOG_SET_MSG(eExportCompressBlocks,				"Failed to compress the exported file")
+LOG_SET_MSG(sExportAnimationBank,				"Exporting the animations to bank file: %s")
+LOG_SET_MSG(eExportAnimationBank,				"Failed to write the animation bank file: %s")
 
 LOG_SET_MSG(iModelInfoNull,						"Model is null")
 LOG_SET_MSG(iModelInfoStart,					"Listing model information:")
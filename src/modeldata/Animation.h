@@ -32,11 +32,14 @@ namespace modeldata {
 	struct Animation : public json::ConstSerializable {
 		std::string id;
 		std::vector<NodeAnimation *> nodeAnimations;
+		/** whether the animation is meant to be played looped (as defined by the clips file) */
+		bool loop;
 
-		Animation() {}
+		Animation() : loop(false) {}
 
 		Animation(const Animation &copyFrom) {
 			id = copyFrom.id;
+			loop = copyFrom.loop;
 			for (std::vector<NodeAnimation *>::const_iterator itr = copyFrom.nodeAnimations.begin(); itr != copyFrom.nodeAnimations.end(); ++itr)
 				nodeAnimations.push_back(new NodeAnimation(*(*itr)));
 		}
@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * Copyright 2011 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+/** @author Xoppa */
+#ifdef _MSC_VER
+#pragma once
+#endif
+#ifndef MODELDATA_ANIMATIONBANK_H
+#define MODELDATA_ANIMATIONBANK_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include "Animation.h"
+#include "TrackCodec.h"
+
+#define ANIMATIONBANK_MAGIC				"C3AB"
+#define ANIMATIONBANK_VERSION			1
+#define ANIMATIONBANK_FORMAT_UBJSON		1
+#define ANIMATIONBANK_FORMAT_JSON		2
+
+namespace fbxconv {
+namespace modeldata {
+	/** Stores the animations of a model separate from the model, as chunks that can be loaded independently, so a runtime can load
+	 * (or stream) a single animation instead of all of them. Each animation is split into chunks of a fixed duration. Each chunk is an
+	 * animation object (serialized like the animations of the model) with the keyframes within its time span plus, for each channel,
+	 * the keyframe just before and just after it, so a chunk can be interpolated on its own. Keyframe times stay relative to the start
+	 * of the animation and the bones reference the nodes of the model by id. All numbers are big endian (like UBJSON):
+	 *   char[4] magic ("C3AB"), uint32 version, uint32 format (1: UBJSON, 2: JSON), float32 chunk duration (ms), uint32 animation count,
+	 *   for each animation: uint16 id length, id (utf-8), float32 duration (ms), uint8 flags (1: loop), uint32 first chunk, uint32 chunk count,
+	 *   uint32 total chunk count, for each chunk: uint64 offset (from the start of the file), uint32 size, float32 start time (ms),
+	 *   followed by the chunks. */
+	class AnimationBank {
+	public:
+		/** Write the animations to the stream, serialize(animation, out) must serialize a chunk to the string in the specified format */
+		template<class F> static bool write(std::ostream &stream, const std::vector<Animation *> &animations, const float &chunkTime,
+			const unsigned int &format, const F &serialize) {
+			std::vector<unsigned char> header;
+			header.insert(header.end(), ANIMATIONBANK_MAGIC, ANIMATIONBANK_MAGIC + 4);
+			writeInt(header, ANIMATIONBANK_VERSION, 4);
+			writeInt(header, format, 4);
+			writeFloat(header, chunkTime);
+			writeInt(header, animations.size(), 4);
+
+			std::vector<std::string> chunks;
+			std::vector<float> startTimes;
+			for (std::vector<Animation *>::const_iterator itr = animations.begin(); itr != animations.end(); ++itr) {
+				const float duration = getDuration(**itr);
+				const unsigned int count = std::max(1U, (unsigned int)ceil(duration / chunkTime));
+				writeInt(header, (*itr)->id.size(), 2);
+				header.insert(header.end(), (*itr)->id.begin(), (*itr)->id.end());
+				writeFloat(header, duration);
+				header.push_back((*itr)->loop ? 1 : 0);
+				writeInt(header, chunks.size(), 4);
+				writeInt(header, count, 4);
+				for (unsigned int i = 0; i < count; i++) {
+					const float start = i * chunkTime;
+					Animation chunk;
+					createChunk(**itr, start, i + 1 < count ? start + chunkTime : duration, chunk);
+					chunks.push_back(std::string());
+					serialize(&chunk, chunks.back());
+					startTimes.push_back(start);
+				}
+			}
+
+			writeInt(header, chunks.size(), 4);
+			unsigned long long offset = header.size() + chunks.size() * 16ULL;
+			for (unsigned int i = 0; i < chunks.size(); i++) {
+				writeInt(header, offset, 8);
+				writeInt(header, chunks[i].size(), 4);
+				writeFloat(header, startTimes[i]);
+				offset += chunks[i].size();
+			}
+			stream.write((const char *)&header[0], header.size());
+			for (std::vector<std::string>::const_iterator itr = chunks.begin(); itr != chunks.end(); ++itr)
+				stream.write(itr->data(), itr->size());
+			return stream.good();
+		}
+
+		/** The time (in milliseconds) of the last keyframe of the animation */
+		static float getDuration(const Animation &animation) {
+			float result = 0.f;
+			for (std::vector<NodeAnimation *>::const_iterator itr = animation.nodeAnimations.begin(); itr != animation.nodeAnimations.end(); ++itr)
+				for (std::vector<Keyframe *>::const_iterator it = (*itr)->keyframes.begin(); it != (*itr)->keyframes.end(); ++it)
+					result = std::max(result, (*it)->time);
+			return result;
+		}
+
+		/** Create the chunk of the animation from start to stop (in milliseconds) in result, which takes ownership of the node animations.
+		 * A keyframe of the animation is added if any of its channels is needed to interpolate the channel within the chunk, only with 
+		 * those channels. Node animations with encoded keyframes are encoded again for the chunk. */
+		static void createChunk(const Animation &animation, const float &start, const float &stop, Animation &result) {
+			result.id = animation.id;
+			result.loop = animation.loop;
+			for (std::vector<NodeAnimation *>::const_iterator itr = animation.nodeAnimations.begin(); itr != animation.nodeAnimations.end(); ++itr) {
+				const std::vector<Keyframe *> &keyframes = (*itr)->keyframes;
+				std::vector<unsigned int> channels(keyframes.size(), 0);
+				for (int c = 0; c < 3; c++) {
+					// The last keyframe of the channel before the chunk and the first one after it, next to the keyframes within the chunk
+					int before = -1, after = -1;
+					for (unsigned int i = 0; i < keyframes.size(); i++) {
+						if (!has(*keyframes[i], c))
+							continue;
+						if (keyframes[i]->time < start)
+							before = (int)i;
+						else if (keyframes[i]->time <= stop)
+							channels[i] |= 1 << c;
+						else if (after < 0)
+							after = (int)i;
+					}
+					if (before >= 0)
+						channels[before] |= 1 << c;
+					if (after >= 0)
+						channels[after] |= 1 << c;
+				}
+				if (std::find_if(channels.begin(), channels.end(), [](const unsigned int &c) { return c != 0; }) == channels.end())
+					continue;
+				NodeAnimation *nodeAnimation = new NodeAnimation();
+				nodeAnimation->node = (*itr)->node;
+				nodeAnimation->translate = (*itr)->translate;
+				nodeAnimation->rotate = (*itr)->rotate;
+				nodeAnimation->scale = (*itr)->scale;
+				nodeAnimation->frameTime = (*itr)->frameTime;
+				result.nodeAnimations.push_back(nodeAnimation);
+				for (unsigned int i = 0; i < keyframes.size(); i++) {
+					if (channels[i] == 0)
+						continue;
+					Keyframe *keyframe = new Keyframe(*keyframes[i]);
+					keyframe->hasTranslation = (channels[i] & 1) != 0;
+					keyframe->hasRotation = (channels[i] & 2) != 0;
+					keyframe->hasScale = (channels[i] & 4) != 0;
+					nodeAnimation->keyframes.push_back(keyframe);
+				}
+				if (!(*itr)->encodedKeyframes.empty() &&
+					!TrackCodec::encode(nodeAnimation->keyframes, nodeAnimation->frameTime, nodeAnimation->encodedKeyframes))
+					nodeAnimation->encodedKeyframes.clear();
+			}
+		}
+
+	private:
+		static inline bool has(const Keyframe &keyframe, const int &channel) {
+			return channel == 0 ? keyframe.hasTranslation : (channel == 1 ? keyframe.hasRotation : keyframe.hasScale);
+		}
+
+		static inline void writeInt(std::vector<unsigned char> &out, const unsigned long long &value, const int &bytes) {
+			for (int i = bytes - 1; i >= 0; i--)
+				out.push_back((unsigned char)(value >> (8 * i)));
+		}
+
+		static inline void writeFloat(std::vector<unsigned char> &out, const float &value) {
+			unsigned int bits;
+			memcpy(&bits, &value, 4);
+			writeInt(out, bits, 4);
+		}
+	};
+} }
+
+#endif //MODELDATA_ANIMATIONBANK_H
@@ -39,15 +39,33 @@
 #define ATTRIBUTE_TEXCOORD7		14
 #define ATTRIBUTE_BLENDINDEX	15
 #define ATTRIBUTE_BLENDWEIGHT	16
-#define ATTRIBUTE_COUNT			17
+#define ATTRIBUTE_QTANGENT		17
+#define ATTRIBUTE_COUNT			18
 
 #define ATTRIBUTE_TYPE_SIGNED	0x00
 #define ATTRIBUTE_TYPE_UNSIGNED	0x80
 #define ATTRIBUTE_TYPE_HEX		0x40
+#define ATTRIBUTE_TYPE_NORMALIZED	0x20
+#define ATTRIBUTE_TYPE_OCTAHEDRAL	0x100
 #define ATTRIBUTE_TYPE_FLOAT	0
 #define ATTRIBUTE_TYPE_INT		1
+#define ATTRIBUTE_TYPE_SHORT	2
+#define ATTRIBUTE_TYPE_BYTE		3
+#define ATTRIBUTE_TYPE_HALF		4
 #define ATTRIBUTE_TYPE_UINT		(ATTRIBUTE_TYPE_INT | ATTRIBUTE_TYPE_UNSIGNED)
 #define ATTRIBUTE_TYPE_UINT_HEX	(ATTRIBUTE_TYPE_UINT | ATTRIBUTE_TYPE_HEX)
+#define ATTRIBUTE_TYPE_UNORM16	(ATTRIBUTE_TYPE_SHORT | ATTRIBUTE_TYPE_UNSIGNED | ATTRIBUTE_TYPE_NORMALIZED)
+#define ATTRIBUTE_TYPE_UNORM8	(ATTRIBUTE_TYPE_BYTE | ATTRIBUTE_TYPE_UNSIGNED | ATTRIBUTE_TYPE_NORMALIZED)
+#define ATTRIBUTE_TYPE_UINT8	(ATTRIBUTE_TYPE_BYTE | ATTRIBUTE_TYPE_UNSIGNED)
+#define ATTRIBUTE_TYPE_SNORM16	(ATTRIBUTE_TYPE_SHORT | ATTRIBUTE_TYPE_NORMALIZED)
+#define ATTRIBUTE_TYPE_SNORM8	(ATTRIBUTE_TYPE_BYTE | ATTRIBUTE_TYPE_NORMALIZED)
+#define ATTRIBUTE_TYPE_UINT16	(ATTRIBUTE_TYPE_SHORT | ATTRIBUTE_TYPE_UNSIGNED)
+// Unit vectors mapped on an octahedron and stored as two normalized signed components
+#define ATTRIBUTE_TYPE_OCT16	(ATTRIBUTE_TYPE_SHORT | ATTRIBUTE_TYPE_NORMALIZED | ATTRIBUTE_TYPE_OCTAHEDRAL)
+#define ATTRIBUTE_TYPE_OCT8		(ATTRIBUTE_TYPE_BYTE | ATTRIBUTE_TYPE_NORMALIZED | ATTRIBUTE_TYPE_OCTAHEDRAL)
+
+#include <string>
+#include <string.h>
 
 #define INIT_VECTOR(T, A) std::vector<T>(A, A + sizeof(A) / sizeof(*A))
 
@@ -56,7 +74,7 @@ namespace modeldata {
 	static const char * AttributeNames[] = {
 		"UNKNOWN", "POSITION", "NORMAL", "COLOR", "COLORPACKED", "TANGENT", "BINORMAL",
 		"TEXCOORD0", "TEXCOORD1", "TEXCOORD2", "TEXCOORD3", "TEXCOORD4", "TEXCOORD5", "TEXCOORD6", "TEXCOORD7",
-        "BLENDINDEX","BLENDWEIGHT",
+        "BLENDINDEX","BLENDWEIGHT", "QTANGENT",
 	};
 
 	static const unsigned short AttributeTypeV2[]		= {ATTRIBUTE_TYPE_FLOAT, ATTRIBUTE_TYPE_FLOAT};
@@ -83,21 +101,121 @@ namespace modeldata {
 		INIT_VECTOR(unsigned short, AttributeTypeV2),		// Texcoord7
         INIT_VECTOR(unsigned short, AttributeTypeV4),		// BlendIndex
         INIT_VECTOR(unsigned short, AttributeTypeV4),		// BlendWeight
+		INIT_VECTOR(unsigned short, AttributeTypeV4),		// QTangent
 	};
 
 	#define ATTRIBUTE_SIZE(idx) (AttributeTypes[idx].size())
 
+	// The names of the component types used in the attribute type descriptors and the --vertex-format option
+	static const struct { unsigned short type; const char *name; } AttributeTypeNames[] = {
+		{ATTRIBUTE_TYPE_FLOAT, "float32"}, {ATTRIBUTE_TYPE_HALF, "float16"},
+		{ATTRIBUTE_TYPE_SNORM16, "snorm16"}, {ATTRIBUTE_TYPE_UNORM16, "unorm16"}, {ATTRIBUTE_TYPE_SHORT, "int16"}, {ATTRIBUTE_TYPE_UINT16, "uint16"},
+		{ATTRIBUTE_TYPE_SNORM8, "snorm8"}, {ATTRIBUTE_TYPE_UNORM8, "unorm8"}, {ATTRIBUTE_TYPE_BYTE, "int8"}, {ATTRIBUTE_TYPE_UINT8, "uint8"},
+		{ATTRIBUTE_TYPE_OCT16, "oct16"}, {ATTRIBUTE_TYPE_OCT8, "oct8"},
+	};
+
 	struct Attributes : public json::ConstSerializable {
+		// Writes the type descriptor (component type, count and byte offset) of each encoded attribute
+		struct TypeDescriptors : public json::ConstSerializable {
+			const Attributes &attributes;
+			TypeDescriptors(const Attributes &attributes) : attributes(attributes) {}
+			virtual void serialize(json::BaseJSONWriter &writer) const;
+		};
+
 		unsigned long value;
+		/** the component type (ATTRIBUTE_TYPE_XXX) each attribute is encoded with, ATTRIBUTE_TYPE_FLOAT if it isn't encoded */
+		unsigned short types[ATTRIBUTE_COUNT];
 
-		Attributes() : value(0) {}
+		Attributes() : value(0) {
+			memset(types, 0, sizeof(types));
+		}
 
-		Attributes(const unsigned long &v) : value(v) {}
+		Attributes(const unsigned long &v) : value(v) {
+			memset(types, 0, sizeof(types));
+		}
 
-		Attributes(const Attributes &copyFrom) : value(copyFrom.value) {}
+		Attributes(const Attributes &copyFrom) : value(copyFrom.value) {
+			memcpy(types, copyFrom.types, sizeof(types));
+		}
 
 		inline bool operator==(const Attributes& rhs) const {
-			return value == rhs.value;
+			return value == rhs.value && memcmp(types, rhs.types, sizeof(types)) == 0;
+		}
+
+		/** the size in bytes of a single component of the specified type */
+		static unsigned int componentSize(const unsigned short &type) {
+			switch(type & 0x0F) {
+			case ATTRIBUTE_TYPE_SHORT: return 2;
+			case ATTRIBUTE_TYPE_HALF: return 2;
+			case ATTRIBUTE_TYPE_BYTE: return 1;
+			default: return 4;
+			}
+		}
+
+		/** the suffix added to the name of an attribute that is encoded with the specified type */
+		static const char *typeSuffix(const unsigned short &type) {
+			switch(type) {
+			case ATTRIBUTE_TYPE_UNORM16: return "_UNORM16";
+			case ATTRIBUTE_TYPE_UNORM8: return "_UNORM8";
+			case ATTRIBUTE_TYPE_UINT8: return "_UINT8";
+			case ATTRIBUTE_TYPE_SNORM16: return "_SNORM16";
+			case ATTRIBUTE_TYPE_SNORM8: return "_SNORM8";
+			case ATTRIBUTE_TYPE_UINT16: return "_UINT16";
+			case ATTRIBUTE_TYPE_SHORT: return "_INT16";
+			case ATTRIBUTE_TYPE_BYTE: return "_INT8";
+			case ATTRIBUTE_TYPE_OCT16: return "_OCT16";
+			case ATTRIBUTE_TYPE_OCT8: return "_OCT8";
+			case ATTRIBUTE_TYPE_HALF: return "_HALF";
+			default: return "";
+			}
+		}
+
+		/** the name of the component type as used in the attribute type descriptors, or 0 if unknown */
+		static const char *typeName(const unsigned short &type) {
+			for (unsigned int i = 0; i < sizeof(AttributeTypeNames) / sizeof(*AttributeTypeNames); i++)
+				if (AttributeTypeNames[i].type == type)
+					return AttributeTypeNames[i].name;
+			return 0;
+		}
+
+		void setComponentType(const unsigned int &attribute, const unsigned short &type) {
+			types[attribute] = type;
+		}
+
+		/** whether any of the attributes is encoded with another type than float */
+		bool isEncoded() const {
+			for (unsigned int i = 0; i < ATTRIBUTE_COUNT; i++)
+				if (has(i) && types[i] != ATTRIBUTE_TYPE_FLOAT)
+					return true;
+			return false;
+		}
+
+		/** the number of components of the attribute when encoded */
+		unsigned int componentCount(const unsigned int &attribute) const {
+			return (types[attribute] & ATTRIBUTE_TYPE_OCTAHEDRAL) ? 2 : (unsigned int)ATTRIBUTE_SIZE(attribute);
+		}
+
+		/** the size in bytes of the attribute when encoded */
+		unsigned int encodedSize(const unsigned int &attribute) const {
+			return has(attribute) ? componentCount(attribute) * componentSize(types[attribute]) : 0;
+		}
+
+		/** the offset in bytes of the attribute within an encoded vertex, or -1 if not available */
+		int encodedOffset(const unsigned int &attribute) const {
+			if (!has(attribute))
+				return -1;
+			unsigned int result = 0;
+			for (unsigned int i = 0; i < attribute; i++)
+				result += encodedSize(i);
+			return (int)result;
+		}
+
+		/** the size in bytes of an encoded vertex */
+		unsigned int stride() const {
+			unsigned int result = 0;
+			for (unsigned int i = 0; i < ATTRIBUTE_COUNT; i++)
+				result += encodedSize(i);
+			return result;
 		}
 
 		unsigned int size() const {
@@ -125,9 +243,20 @@ namespace modeldata {
 		}
 
 		/** 0 <= index < length() */
-		const char *name(const unsigned int &index) const {
+		std::string name(const unsigned int &index) const {
 			const int a = get(index);
-			return a < 0 ? 0 : AttributeNames[a];
+			return a < 0 ? std::string() : std::string(AttributeNames[a]) + typeSuffix(types[a]);
+		}
+
+		/** the offset (in number of floats) of the attribute within the vertex, or -1 if the attribute isn't present */
+		const int offset(const unsigned int &attribute) const {
+			if (!has(attribute))
+				return -1;
+			int result = 0;
+			for (unsigned int i = 0; i < attribute; i++)
+				if (has(i))
+					result += (int)ATTRIBUTE_SIZE(i);
+			return result;
 		}
 
 		/** 0 <= v < size() */
@@ -138,7 +267,7 @@ namespace modeldata {
 					continue;
 				const unsigned short is = (unsigned short)ATTRIBUTE_SIZE(i);
 				if ((s + is) > v)
-					return AttributeTypes[i][v-s];
+					return types[i] != ATTRIBUTE_TYPE_FLOAT ? types[i] : AttributeTypes[i][v-s];
 				s+=is;
 			}
 			return 0;
@@ -211,6 +340,14 @@ namespace modeldata {
 			set(ATTRIBUTE_BINORMAL, v);
 		}
 
+		inline bool hasQTangent() const {
+			return has(ATTRIBUTE_QTANGENT);
+		}
+
+		void hasQTangent(const bool &v) {
+			set(ATTRIBUTE_QTANGENT, v);
+		}
+
 		inline bool hasUV(const unsigned short &uv) const {
 			return has(ATTRIBUTE_TEXCOORD0 + uv);
 		}
@@ -0,0 +1,284 @@
+/*******************************************************************************
+ * Copyright 2011 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+/** @author Xoppa */
+#ifdef _MSC_VER
+#pragma once
+#endif
+#ifndef MODELDATA_INDEXCODEC_H
+#define MODELDATA_INDEXCODEC_H
+
+#include <vector>
+
+#define INDEXCODEC_NAME			"fifo1"
+#define INDEXCODEC_EDGE_FIFO	15
+#define INDEXCODEC_VERTEX_FIFO	14
+
+namespace fbxconv {
+namespace modeldata {
+	/** Compresses triangle lists using the adjacency of consecutive triangles.
+	 * Each triangle is written as a code byte, optionally followed by a second code byte and variable length integers:
+	 *   The high nibble of the first code is the index of a recently seen edge (shared with a previous triangle) in the edge fifo,
+	 *   or 15 if the triangle doesn't share a recent edge. The triangle is rotated (keeping its winding) so the shared edge comes first.
+	 *   Each vertex that isn't part of the shared edge is written as a nibble: 0 for the next unused vertex index, 1..14 for
+	 *   an index in the vertex fifo or 15 for an explicit index, which follows as a zigzag varint delta to the previous explicit index.
+	 *   With a shared edge, the low nibble of the first code is the third vertex; otherwise the low nibble of the first code
+	 *   and both nibbles of the second code are the three vertices.
+	 * The encoded data starts with the number of indices (a multiple of 3) as varint. Decoding requires a single pass without lookups in the output.
+	 * Triangles keep their order and winding, but may start at another vertex. */
+	class IndexCodec {
+	public:
+		/** Encode the triangle list, the number of indices must be a multiple of 3 */
+		static void encode(const std::vector<unsigned int> &indices, std::vector<unsigned char> &out) {
+			State state;
+			out.clear();
+			writeVarint(out, (unsigned int)indices.size());
+			const unsigned int triangleCount = (unsigned int)indices.size() / 3;
+			for (unsigned int t = 0; t < triangleCount; t++) {
+				unsigned int tri[3] = {indices[t*3], indices[t*3+1], indices[t*3+2]};
+				int edge = -1;
+				for (int r = 0; r < 3 && edge < 0; r++) {
+					edge = state.findEdge(tri[r], tri[(r+1)%3]);
+					if (edge >= 0 && r > 0)
+						rotate(tri, r);
+				}
+				if (edge >= 0) {
+					const unsigned char code = vertexCode(state, tri[2]);
+					out.push_back((unsigned char)((edge << 4) | code));
+					writeVertex(state, out, code, tri[2]);
+				}
+				else {
+					// The code of each vertex depends on the state after the previous vertex, the varints follow the codes
+					unsigned char codes[3];
+					std::vector<unsigned char> varints;
+					for (int i = 0; i < 3; i++) {
+						codes[i] = vertexCode(state, tri[i]);
+						writeVertex(state, varints, codes[i], tri[i]);
+					}
+					out.push_back((unsigned char)(0xF0 | codes[0]));
+					out.push_back((unsigned char)((codes[1] << 4) | codes[2]));
+					out.insert(out.end(), varints.begin(), varints.end());
+				}
+				state.pushTriangle(tri);
+			}
+		}
+
+		/** Decode the data, returns false if the data is malformed. This is the reference decoder for the c3db index codec. */
+		static bool decode(const unsigned char * const &data, const unsigned int &size, std::vector<unsigned int> &indices) {
+			State state;
+			unsigned int pos = 0, count;
+			// Each triangle takes at least one byte
+			if (!readVarint(data, size, pos, count) || count % 3 != 0 || count / 3 > size - pos)
+				return false;
+			indices.resize(count);
+			const unsigned int triangleCount = count / 3;
+			for (unsigned int t = 0; t < triangleCount; t++) {
+				if (pos >= size)
+					return false;
+				const unsigned char code = data[pos++];
+				unsigned int tri[3];
+				if ((code >> 4) < INDEXCODEC_EDGE_FIFO) {
+					if ((code >> 4) >= state.edgeCount)
+						return false;
+					tri[0] = state.edges[code >> 4][0];
+					tri[1] = state.edges[code >> 4][1];
+					if (!readVertex(state, data, size, pos, code & 0x0F, tri[2]))
+						return false;
+				}
+				else {
+					if (pos >= size)
+						return false;
+					const unsigned char code2 = data[pos++];
+					if (!readVertex(state, data, size, pos, code & 0x0F, tri[0]) ||
+							!readVertex(state, data, size, pos, code2 >> 4, tri[1]) ||
+							!readVertex(state, data, size, pos, code2 & 0x0F, tri[2]))
+						return false;
+				}
+				indices[t*3] = tri[0];
+				indices[t*3+1] = tri[1];
+				indices[t*3+2] = tri[2];
+				state.pushTriangle(tri);
+			}
+			return pos == size;
+		}
+
+		/** Whether the decoded indices describe the same triangles as the original indices, allowing the rotation of each triangle */
+		static bool isEquivalent(const std::vector<unsigned int> &original, const std::vector<unsigned int> &decoded) {
+			if (original.size() != decoded.size())
+				return false;
+			const unsigned int triangleCount = (unsigned int)original.size() / 3;
+			for (unsigned int t = 0; t < triangleCount; t++) {
+				const unsigned int * const a = &original[t*3], * const b = &decoded[t*3];
+				bool match = false;
+				for (int r = 0; r < 3 && !match; r++)
+					match = a[r] == b[0] && a[(r+1)%3] == b[1] && a[(r+2)%3] == b[2];
+				if (!match)
+					return false;
+			}
+			return true;
+		}
+
+		/** Check that degenerate, strip ordered and random triangle lists survive encoding and decoding, returns false if any doesn't */
+		static bool test() {
+			std::vector<std::vector<unsigned int> > lists(3);
+			// Degenerate triangles, repeated triangles and a triangle far from the others
+			const unsigned int degenerate[] = { 0, 0, 0, 0, 1, 1, 1, 2, 1, 2, 2, 2, 0, 1, 2, 0, 1, 2, 2, 1, 0, 100000, 7, 100000 };
+			lists[0].assign(degenerate, degenerate + sizeof(degenerate) / sizeof(*degenerate));
+			// A triangle strip converted to a list, alternating the winding
+			for (unsigned int i = 0; i < 1000; i++) {
+				lists[1].push_back(i);
+				lists[1].push_back(i + 1 + (i & 1));
+				lists[1].push_back(i + 2 - (i & 1));
+			}
+			// Random triangles (using a fixed linear congruential generator) referencing both nearby and far away vertices
+			unsigned int seed = 12345;
+			for (unsigned int i = 0; i < 3000; i++) {
+				seed = seed * 1664525u + 1013904223u;
+				lists[2].push_back((seed >> 8) % ((i & 4) ? 64u : 0x1000000u));
+			}
+			std::vector<unsigned char> encoded;
+			std::vector<unsigned int> decoded;
+			for (std::vector<std::vector<unsigned int> >::const_iterator itr = lists.begin(); itr != lists.end(); ++itr) {
+				encode(*itr, encoded);
+				if (!decode(&encoded[0], (unsigned int)encoded.size(), decoded) || !isEquivalent(*itr, decoded))
+					return false;
+			}
+			return true;
+		}
+
+	private:
+		struct State {
+			unsigned int edges[INDEXCODEC_EDGE_FIFO][2];
+			unsigned int vertices[INDEXCODEC_VERTEX_FIFO];
+			unsigned int edgeCount, vertexCount;
+			// The next unused vertex index and the last explicit vertex index
+			unsigned int next, last;
+
+			State() : edgeCount(0), vertexCount(0), next(0), last(0) {}
+
+			int findEdge(const unsigned int &a, const unsigned int &b) const {
+				for (unsigned int i = 0; i < edgeCount; i++)
+					if (edges[i][0] == a && edges[i][1] == b)
+						return (int)i;
+				return -1;
+			}
+
+			int findVertex(const unsigned int &v) const {
+				for (unsigned int i = 0; i < vertexCount; i++)
+					if (vertices[i] == v)
+						return (int)i;
+				return -1;
+			}
+
+			void pushEdge(const unsigned int &a, const unsigned int &b) {
+				if (edgeCount < INDEXCODEC_EDGE_FIFO)
+					edgeCount++;
+				for (unsigned int i = edgeCount - 1; i > 0; i--) {
+					edges[i][0] = edges[i-1][0];
+					edges[i][1] = edges[i-1][1];
+				}
+				edges[0][0] = a;
+				edges[0][1] = b;
+			}
+
+			void pushVertex(const unsigned int &v) {
+				if (vertexCount < INDEXCODEC_VERTEX_FIFO)
+					vertexCount++;
+				for (unsigned int i = vertexCount - 1; i > 0; i--)
+					vertices[i] = vertices[i-1];
+				vertices[0] = v;
+			}
+
+			// The edges are stored reversed, as that's how an adjacent triangle (with the same winding) references them
+			void pushTriangle(const unsigned int (&tri)[3]) {
+				pushEdge(tri[0], tri[2]);
+				pushEdge(tri[2], tri[1]);
+				pushEdge(tri[1], tri[0]);
+			}
+		};
+
+		static inline void rotate(unsigned int (&tri)[3], const int &r) {
+			const unsigned int t[3] = {tri[0], tri[1], tri[2]};
+			for (int i = 0; i < 3; i++)
+				tri[i] = t[(i + r) % 3];
+		}
+
+		static inline unsigned char vertexCode(const State &state, const unsigned int &v) {
+			if (v == state.next)
+				return 0;
+			const int f = state.findVertex(v);
+			return f >= 0 ? (unsigned char)(f + 1) : 15;
+		}
+
+		static void writeVertex(State &state, std::vector<unsigned char> &out, const unsigned char &code, const unsigned int &v) {
+			if (code == 0)
+				state.next++;
+			else if (code == 15) {
+				const int delta = (int)(v - state.last);
+				writeVarint(out, ((unsigned int)delta << 1) ^ (unsigned int)(delta >> 31));
+				state.last = v;
+				if (v >= state.next)
+					state.next = v + 1;
+			}
+			if (code == 0 || code == 15)
+				state.pushVertex(v);
+		}
+
+		static bool readVertex(State &state, const unsigned char * const &data, const unsigned int &size, unsigned int &pos, const unsigned char &code, unsigned int &v) {
+			if (code == 0)
+				v = state.next++;
+			else if (code == 15) {
+				unsigned int zigzag;
+				if (!readVarint(data, size, pos, zigzag))
+					return false;
+				v = state.last + (unsigned int)((int)(zigzag >> 1) ^ -(int)(zigzag & 1));
+				state.last = v;
+				if (v >= state.next)
+					state.next = v + 1;
+			}
+			else if ((unsigned int)code - 1 < state.vertexCount) {
+				v = state.vertices[code - 1];
+				return true;
+			}
+			else
+				return false;
+			state.pushVertex(v);
+			return true;
+		}
+
+		static inline void writeVarint(std::vector<unsigned char> &out, unsigned int v) {
+			while (v >= 0x80) {
+				out.push_back((unsigned char)(v | 0x80));
+				v >>= 7;
+			}
+			out.push_back((unsigned char)v);
+		}
+
+		static inline bool readVarint(const unsigned char * const &data, const unsigned int &size, unsigned int &pos, unsigned int &v) {
+			v = 0;
+			for (unsigned int shift = 0; shift < 35; shift += 7) {
+				if (pos >= size)
+					return false;
+				const unsigned char b = data[pos++];
+				v |= (unsigned int)(b & 0x7F) << shift;
+				if ((b & 0x80) == 0)
+					return true;
+			}
+			return false;
+		}
+	};
+} }
+
+#endif //MODELDATA_INDEXCODEC_H
@@ -30,16 +30,24 @@ namespace modeldata {
 		float translation[3];
 		float rotation[4];
 		float scale[3];
+		/** the derivatives (per millisecond) of the channels, the segment between two keyframes with tangents is a cubic Hermite curve */
+		float translationTangent[3];
+		float rotationTangent[4];
+		float scaleTangent[3];
 		bool hasTranslation;
 		bool hasRotation;
 		bool hasScale;
+		bool hasTangents;
 
 		Keyframe() {
 			time = 0.;
 			translation[0] = translation[1] = translation[2] = 0.;
 			rotation[0] = rotation[1] = rotation[2] = 0.; rotation[3] = 1.;
 			scale[0] = scale[1] = scale[2] = 1.;
-			hasTranslation = hasRotation = hasScale = false;
+			memset(translationTangent, 0, sizeof(translationTangent));
+			memset(rotationTangent, 0, sizeof(rotationTangent));
+			memset(scaleTangent, 0, sizeof(scaleTangent));
+			hasTranslation = hasRotation = hasScale = hasTangents = false;
 		}
 
 		Keyframe(const Keyframe &rhs) {
@@ -47,9 +55,13 @@ namespace modeldata {
 			memcpy(translation, rhs.translation, sizeof(translation));
 			memcpy(rotation, rhs.rotation, sizeof(rotation));
 			memcpy(scale, rhs.scale, sizeof(scale));
+			memcpy(translationTangent, rhs.translationTangent, sizeof(translationTangent));
+			memcpy(rotationTangent, rhs.rotationTangent, sizeof(rotationTangent));
+			memcpy(scaleTangent, rhs.scaleTangent, sizeof(scaleTangent));
 			hasTranslation = rhs.hasTranslation;
 			hasRotation = rhs.hasRotation;
 			hasScale = rhs.hasScale;
+			hasTangents = rhs.hasTangents;
 		}
 
 		virtual void serialize(json::BaseJSONWriter &writer) const;
@@ -21,6 +21,8 @@
 #define MODELDATA_MESH_H
 
 #include <vector>
+#include <unordered_map>
+#include <math.h>
 #include "MeshPart.h"
 #include "Attributes.h"
 #include "../json/BaseJSONWriter.h"
@@ -37,19 +39,35 @@ namespace modeldata {
 		std::vector<float> _vertices;
 		/** hash lookup table for faster duplicate vertex checking */
 		std::vector<unsigned int> _hashes;
+		/** maps each hash to the vertices with that hash, so large meshes don't need a linear search */
+		std::unordered_multimap<unsigned int, unsigned int> _hashIndex;
 		/** the indexed parts of this mesh */
 		std::vector<MeshPart *> _parts;
         std::string _name;
+		/** the vertices encoded (little endian) according to the component types of the attributes, empty if the mesh isn't encoded */
+		std::vector<unsigned char> _encodedVertices;
+		/** the size (in bytes) of each encoded vertex */
+		unsigned int _vertexStride;
+		/** the encoded vertices compressed with the vertex codec (see VertexCodec), serialized instead of the encoded vertices if not empty */
+		std::vector<unsigned char> _compressedVertices;
+		/** the dequantization of encoded positions: position = offset + scale * value */
+		float _positionOffset[3];
+		float _positionScale[3];
 
 		/** ctor */
-		Mesh() : _attributes(0), _vertexSize(0), _name("unnammed") {}
+		Mesh() : _attributes(0), _vertexSize(0), _name("unnammed"), _vertexStride(0) {}
 
 		/** copy constructor */
 		Mesh(const Mesh &copyFrom) {
             _name = copyFrom._name;
 			_attributes = copyFrom._attributes;
 			_vertexSize = copyFrom._vertexSize;
+			_vertexStride = copyFrom._vertexStride;
+			memcpy(_positionOffset, copyFrom._positionOffset, sizeof(_positionOffset));
+			memcpy(_positionScale, copyFrom._positionScale, sizeof(_positionScale));
 			_vertices.insert(_vertices.end(), copyFrom._vertices.begin(), copyFrom._vertices.end());
+			_encodedVertices.insert(_encodedVertices.end(), copyFrom._encodedVertices.begin(), copyFrom._encodedVertices.end());
+			_compressedVertices = copyFrom._compressedVertices;
 			for (std::vector<MeshPart *>::const_iterator itr = copyFrom._parts.begin(); itr != copyFrom._parts.end(); ++itr)
 				_parts.push_back(new MeshPart(**itr));
 		}
@@ -60,7 +78,11 @@ namespace modeldata {
 
 		void clear() {
 			_vertices.clear();
+			_encodedVertices.clear();
+			_compressedVertices.clear();
+			_vertexStride = 0;
 			_hashes.clear();
+			_hashIndex.clear();
 			_attributes = _vertexSize = 0;
 			for (std::vector<MeshPart *>::iterator itr = _parts.begin(); itr != _parts.end(); ++itr)
 				delete (*itr);
@@ -78,15 +100,413 @@ namespace modeldata {
 			return _vertices.size() / _vertexSize;
 		}
 
+		/** set the size in bits (16 or 32) used to serialize the indices of all parts */
+		void setIndexWidth(const unsigned int &bits) {
+			for (std::vector<MeshPart *>::iterator itr = _parts.begin(); itr != _parts.end(); ++itr)
+				(*itr)->indexWidth = bits;
+		}
+
 		inline unsigned int add(const float *vertex) {
 			const unsigned int hash = calcHash(vertex, _vertexSize);
-			const unsigned int n = (unsigned int)_hashes.size();
-			for (unsigned int i = 0; i < n; i++)
-				if ((_hashes[i] == hash) && compare(&_vertices[i*_vertexSize], vertex, _vertexSize))
-					return i;
+			typedef std::unordered_multimap<unsigned int, unsigned int>::const_iterator HashIterator;
+			const std::pair<HashIterator, HashIterator> range = _hashIndex.equal_range(hash);
+			for (HashIterator itr = range.first; itr != range.second; ++itr)
+				if (compare(&_vertices[itr->second*_vertexSize], vertex, _vertexSize))
+					return itr->second;
+			const unsigned int index = (unsigned int)_hashes.size();
 			_hashes.push_back(hash);
+			_hashIndex.insert(std::make_pair(hash, index));
 			_vertices.insert(_vertices.end(), &vertex[0], &vertex[_vertexSize]);
-			return (unsigned int)_hashes.size() - 1;
+			return index;
+		}
+
+		/** move all parts and vertices of the other mesh (which must have the same attributes) into this mesh */
+		void merge(Mesh &other) {
+			const unsigned int count = other.vertexCount();
+			std::vector<unsigned int> remap(count);
+			for (unsigned int i = 0; i < count; i++)
+				remap[i] = add(&other._vertices[i * _vertexSize]);
+			for (std::vector<MeshPart *>::iterator itr = other._parts.begin(); itr != other._parts.end(); ++itr) {
+				for (std::vector<unsigned int>::iterator idx = (*itr)->indices.begin(); idx != (*itr)->indices.end(); ++idx)
+					*idx = remap[*idx];
+				_parts.push_back(*itr);
+			}
+			other._parts.clear();
+		}
+
+		/** remove all vertices which aren't referenced by any of the parts */
+		void removeUnusedVertices() {
+			const unsigned int count = vertexCount();
+			std::vector<unsigned int> remap(count, (unsigned int)-1);
+			for (std::vector<MeshPart *>::const_iterator itr = _parts.begin(); itr != _parts.end(); ++itr)
+				for (std::vector<unsigned int>::const_iterator idx = (*itr)->indices.begin(); idx != (*itr)->indices.end(); ++idx)
+					remap[*idx] = 0;
+			std::vector<float> vertices;
+			vertices.swap(_vertices);
+			_hashes.clear();
+			_hashIndex.clear();
+			for (unsigned int i = 0; i < count; i++)
+				if (remap[i] == 0)
+					remap[i] = add(&vertices[i * _vertexSize]);
+			for (std::vector<MeshPart *>::iterator itr = _parts.begin(); itr != _parts.end(); ++itr)
+				for (std::vector<unsigned int>::iterator idx = (*itr)->indices.begin(); idx != (*itr)->indices.end(); ++idx)
+					*idx = remap[*idx];
+		}
+
+		/** rebuild the vertices with the specified (float) attributes, where source[a] is the current attribute that provides attribute a
+		 * of the new vertices (e.g. to renumber the texture coordinates). Vertices that become equal are merged. */
+		void setAttributes(const Attributes &attributes, const int (&source)[ATTRIBUTE_COUNT]) {
+			const Attributes current = _attributes;
+			const unsigned int currentSize = _vertexSize;
+			const unsigned int count = vertexCount();
+			std::vector<float> vertices;
+			vertices.swap(_vertices);
+			_hashes.clear();
+			_hashIndex.clear();
+			_attributes = attributes;
+			_vertexSize = attributes.size();
+			std::vector<float> vertex(_vertexSize);
+			std::vector<unsigned int> remap(count);
+			for (unsigned int i = 0; i < count; i++) {
+				for (unsigned int a = 0; a < ATTRIBUTE_COUNT; a++)
+					if (attributes.has(a))
+						memcpy(&vertex[attributes.offset(a)], &vertices[i * currentSize + current.offset(source[a])], ATTRIBUTE_SIZE(a) * sizeof(float));
+				remap[i] = add(&vertex[0]);
+			}
+			for (std::vector<MeshPart *>::iterator itr = _parts.begin(); itr != _parts.end(); ++itr)
+				for (std::vector<unsigned int>::iterator idx = (*itr)->indices.begin(); idx != (*itr)->indices.end(); ++idx)
+					*idx = remap[*idx];
+		}
+
+		/** calculate the uv transform of each part for the texture coordinates that are encoded as normalized integers, using the known
+		 * bounds of the part if they contain all its texture coordinates. Vertices shared by parts with different transforms are duplicated, 
+		 * returns false (without modifying the mesh) if that would result in more than maxVertexCount vertices. */
+		bool calculateUVTransforms(const unsigned int &maxVertexCount) {
+			unsigned int uvCount = 0;
+			for (unsigned int a = ATTRIBUTE_TEXCOORD0; a <= ATTRIBUTE_TEXCOORD7; a++)
+				if (_attributes.has(a) && (_attributes.types[a] & ATTRIBUTE_TYPE_NORMALIZED))
+					uvCount = a - ATTRIBUTE_TEXCOORD0 + 1;
+			if (uvCount == 0)
+				return true;
+
+			std::vector<std::vector<float> > transforms(_parts.size());
+			for (unsigned int p = 0; p < _parts.size(); p++) {
+				const MeshPart * const &part = _parts[p];
+				std::vector<float> &transform = transforms[p];
+				transform.resize(4 * uvCount);
+				for (unsigned int k = 0; k < uvCount; k++) {
+					const unsigned int a = ATTRIBUTE_TEXCOORD0 + k;
+					transform[4*k] = transform[4*k+1] = 0.f;
+					transform[4*k+2] = transform[4*k+3] = 1.f;
+					if (!_attributes.has(a) || !(_attributes.types[a] & ATTRIBUTE_TYPE_NORMALIZED) || part->indices.empty())
+						continue;
+					const int offset = _attributes.offset(a);
+					float bounds[4];
+					for (unsigned int i = 0; i < part->indices.size(); i++) {
+						const float * const uv = &_vertices[part->indices[i] * _vertexSize + offset];
+						for (int j = 0; j < 2; j++) {
+							if (i == 0 || uv[j] < bounds[j])
+								bounds[j] = uv[j];
+							if (i == 0 || uv[j] > bounds[j+2])
+								bounds[j+2] = uv[j];
+						}
+					}
+					if (part->uvBounds.size() >= 4 * (k + 1) && part->uvBounds[4*k] <= bounds[0] && part->uvBounds[4*k+1] <= bounds[1] && 
+							part->uvBounds[4*k+2] >= bounds[2] && part->uvBounds[4*k+3] >= bounds[3])
+						memcpy(bounds, &part->uvBounds[4*k], sizeof(bounds));
+					transform[4*k] = bounds[0];
+					transform[4*k+1] = bounds[1];
+					transform[4*k+2] = bounds[2] > bounds[0] ? bounds[2] - bounds[0] : 1.f;
+					transform[4*k+3] = bounds[3] > bounds[1] ? bounds[3] - bounds[1] : 1.f;
+				}
+			}
+
+			// The first part using a vertex owns it, other parts with another transform need a copy of it
+			const unsigned int count = vertexCount();
+			std::vector<int> owner(count, -1);
+			std::vector<std::unordered_map<unsigned int, unsigned int> > copies(_parts.size());
+			unsigned int copyCount = 0;
+			for (unsigned int p = 0; p < _parts.size(); p++) {
+				for (std::vector<unsigned int>::const_iterator itr = _parts[p]->indices.begin(); itr != _parts[p]->indices.end(); ++itr) {
+					if (owner[*itr] < 0)
+						owner[*itr] = (int)p;
+					else if (transforms[owner[*itr]] != transforms[p] && copies[p].find(*itr) == copies[p].end())
+						copies[p][*itr] = count + copyCount++;
+				}
+			}
+			if (count + copyCount > maxVertexCount)
+				return false;
+
+			_vertices.resize((count + copyCount) * _vertexSize);
+			_hashes.resize(count + copyCount);
+			for (unsigned int p = 0; p < _parts.size(); p++) {
+				for (std::unordered_map<unsigned int, unsigned int>::const_iterator itr = copies[p].begin(); itr != copies[p].end(); ++itr) {
+					memcpy(&_vertices[itr->second * _vertexSize], &_vertices[itr->first * _vertexSize], _vertexSize * sizeof(float));
+					_hashes[itr->second] = _hashes[itr->first];
+					_hashIndex.insert(std::make_pair(_hashes[itr->second], itr->second));
+				}
+				if (!copies[p].empty())
+					for (std::vector<unsigned int>::iterator itr = _parts[p]->indices.begin(); itr != _parts[p]->indices.end(); ++itr)
+						if (copies[p].find(*itr) != copies[p].end())
+							*itr = copies[p][*itr];
+				_parts[p]->uvTransforms = transforms[p];
+			}
+			return true;
+		}
+
+		/** encode the vertices according to the component types of the attributes, the maximum error of each attribute 
+		 * is stored in errors (the angle in degrees for octahedral encoded attributes) */
+		void encode(float (&errors)[ATTRIBUTE_COUNT]) {
+			const unsigned int count = vertexCount();
+			_vertexStride = _attributes.stride();
+			_encodedVertices.assign(count * _vertexStride, 0);
+			memset(errors, 0, sizeof(errors));
+
+			const int positionOffset = _attributes.offset(ATTRIBUTE_POSITION);
+			const bool quantizePositions = positionOffset >= 0 && (_attributes.types[ATTRIBUTE_POSITION] & ATTRIBUTE_TYPE_NORMALIZED);
+			if (quantizePositions) {
+				for (int j = 0; j < 3; j++) {
+					float min = 0.f, max = 0.f;
+					for (unsigned int v = 0; v < count; v++) {
+						const float &p = _vertices[v * _vertexSize + positionOffset + j];
+						if (v == 0 || p < min)
+							min = p;
+						if (v == 0 || p > max)
+							max = p;
+					}
+					_positionOffset[j] = min;
+					_positionScale[j] = max > min ? max - min : 1.f;
+				}
+			}
+
+			// The part of each vertex, used for the uv transform
+			std::vector<const MeshPart *> parts(count, (const MeshPart *)0);
+			for (std::vector<MeshPart *>::const_iterator itr = _parts.begin(); itr != _parts.end(); ++itr)
+				if (!(*itr)->uvTransforms.empty())
+					for (std::vector<unsigned int>::const_iterator idx = (*itr)->indices.begin(); idx != (*itr)->indices.end(); ++idx)
+						parts[*idx] = *itr;
+
+			for (unsigned int v = 0; v < count; v++) {
+				const float * const vertex = &_vertices[v * _vertexSize];
+				unsigned char *dest = &_encodedVertices[v * _vertexStride];
+				for (unsigned int a = 0; a < ATTRIBUTE_COUNT; a++) {
+					if (!_attributes.has(a))
+						continue;
+					const float * const src = &vertex[_attributes.offset(a)];
+					const unsigned short &type = _attributes.types[a];
+					const unsigned int size = (unsigned int)ATTRIBUTE_SIZE(a);
+					if (a == ATTRIBUTE_POSITION && quantizePositions) {
+						for (unsigned int j = 0; j < size; j++) {
+							const double value = (src[j] - _positionOffset[j]) / _positionScale[j];
+							const double decoded = _positionOffset[j] + _positionScale[j] * decodeComponent(type, encodeComponent(type, value));
+							errors[a] = std::max(errors[a], (float)fabs(decoded - src[j]));
+							dest = writeComponent(dest, type, encodeComponent(type, value));
+						}
+					}
+					else if (a >= ATTRIBUTE_TEXCOORD0 && a <= ATTRIBUTE_TEXCOORD7 && (type & ATTRIBUTE_TYPE_NORMALIZED)) {
+						const unsigned int k = a - ATTRIBUTE_TEXCOORD0;
+						const float * const transform = (parts[v] != 0 && parts[v]->uvTransforms.size() >= 4 * (k + 1)) ? &parts[v]->uvTransforms[4*k] : 0;
+						for (unsigned int j = 0; j < size; j++) {
+							const double offset = transform ? transform[j] : 0., scale = transform ? transform[j+2] : 1.;
+							const unsigned int encoded = encodeComponent(type, (src[j] - offset) / scale);
+							errors[a] = std::max(errors[a], (float)fabs(offset + scale * decodeComponent(type, encoded) - src[j]));
+							dest = writeComponent(dest, type, encoded);
+						}
+					}
+					else if (a == ATTRIBUTE_BLENDWEIGHT && (type & ATTRIBUTE_TYPE_NORMALIZED)) {
+						unsigned int encoded[4];
+						errors[a] = std::max(errors[a], encodeWeights(type, src, encoded));
+						for (unsigned int j = 0; j < 4; j++)
+							dest = writeComponent(dest, type, encoded[j]);
+					}
+					else if (type & ATTRIBUTE_TYPE_OCTAHEDRAL) {
+						unsigned int encoded[2];
+						errors[a] = std::max(errors[a], octEncode(type, src, encoded));
+						dest = writeComponent(dest, type, encoded[0]);
+						dest = writeComponent(dest, type, encoded[1]);
+					}
+					else if (type == ATTRIBUTE_TYPE_FLOAT) {
+						for (unsigned int j = 0; j < size; j++) {
+							unsigned int bits;
+							memcpy(&bits, &src[j], sizeof(bits));
+							dest = writeComponent(dest, type, bits);
+						}
+					}
+					else {
+						for (unsigned int j = 0; j < size; j++) {
+							const unsigned int encoded = encodeComponent(type, src[j]);
+							errors[a] = std::max(errors[a], (float)fabs(decodeComponent(type, encoded) - src[j]));
+							dest = writeComponent(dest, type, encoded);
+						}
+					}
+				}
+			}
+		}
+
+		/** map the unit vector on the octahedron and encode the two components, picking the rounding that results in the 
+		 * smallest error. Returns the angle (in degrees) between the vector and the decoded vector. */
+		static float octEncode(const unsigned short &type, const float * const &vector, unsigned int (&result)[2]) {
+			const double l1 = fabs(vector[0]) + fabs(vector[1]) + fabs(vector[2]);
+			double u = l1 > 0. ? vector[0] / l1 : 0., w = l1 > 0. ? vector[1] / l1 : 0.;
+			if (vector[2] < 0.f) {
+				const double t = u;
+				u = (1. - fabs(w)) * (t >= 0. ? 1. : -1.);
+				w = (1. - fabs(t)) * (w >= 0. ? 1. : -1.);
+			}
+			const double length = sqrt((double)vector[0] * vector[0] + (double)vector[1] * vector[1] + (double)vector[2] * vector[2]);
+			const double max = (double)((1 << (Attributes::componentSize(type) * 8 - 1)) - 1);
+			double best = -2.;
+			for (int i = 0; i < 4; i++) {
+				const double cu = ((i & 1) ? ceil(u * max) : floor(u * max)) / max;
+				const double cw = ((i & 2) ? ceil(w * max) : floor(w * max)) / max;
+				const unsigned int encoded[2] = { encodeComponent(type, cu), encodeComponent(type, cw) };
+				double decoded[3];
+				octDecode(decodeComponent(type, encoded[0]), decodeComponent(type, encoded[1]), decoded);
+				const double dot = length > 0. ? (decoded[0] * vector[0] + decoded[1] * vector[1] + decoded[2] * vector[2]) / length : 1.;
+				if (dot > best) {
+					best = dot;
+					result[0] = encoded[0];
+					result[1] = encoded[1];
+				}
+			}
+			return (float)(acos(std::min(std::max(best, -1.), 1.)) * 180. / 3.14159265358979323846);
+		}
+
+		/** the unit vector of the two octahedral components */
+		static void octDecode(const double &u, const double &w, double (&result)[3]) {
+			result[2] = 1. - fabs(u) - fabs(w);
+			if (result[2] < 0.) {
+				result[0] = (1. - fabs(w)) * (u >= 0. ? 1. : -1.);
+				result[1] = (1. - fabs(u)) * (w >= 0. ? 1. : -1.);
+			}
+			else {
+				result[0] = u;
+				result[1] = w;
+			}
+			const double length = sqrt(result[0] * result[0] + result[1] * result[1] + result[2] * result[2]);
+			for (int i = 0; i < 3; i++)
+				result[i] /= length;
+		}
+
+		/** convert the value to the integer representation of the component type */
+		static unsigned int encodeComponent(const unsigned short &type, const double &value) {
+			if ((type & 0x0F) == ATTRIBUTE_TYPE_HALF)
+				return floatToHalf((float)value);
+			const unsigned int bits = Attributes::componentSize(type) * 8;
+			if (type & ATTRIBUTE_TYPE_NORMALIZED) {
+				if (type & ATTRIBUTE_TYPE_UNSIGNED)
+					return (unsigned int)floor(std::min(std::max(value, 0.), 1.) * ((1u << bits) - 1) + 0.5);
+				const int max = (1 << (bits - 1)) - 1;
+				return (unsigned int)(int)floor(std::min(std::max(value, -1.), 1.) * max + 0.5) & (bits == 32 ? 0xFFFFFFFFu : (1u << bits) - 1);
+			}
+			// Clamp to the range of the type instead of wrapping around
+			const double min = (type & ATTRIBUTE_TYPE_UNSIGNED) ? 0. : -ldexp(1., bits - 1);
+			const double max = (type & ATTRIBUTE_TYPE_UNSIGNED) ? ldexp(1., bits) - 1. : ldexp(1., bits - 1) - 1.;
+			const double v = std::min(std::max(floor(value + 0.5), min), max);
+			return (type & ATTRIBUTE_TYPE_UNSIGNED) ? (unsigned int)v : (unsigned int)(int)v & (bits == 32 ? 0xFFFFFFFFu : (1u << bits) - 1);
+		}
+
+		/** convert the integer representation of the component type back to its value */
+		static double decodeComponent(const unsigned short &type, const unsigned int &value) {
+			if ((type & 0x0F) == ATTRIBUTE_TYPE_HALF)
+				return halfToFloat((unsigned short)value);
+			const unsigned int bits = Attributes::componentSize(type) * 8;
+			const bool isSigned = (type & ATTRIBUTE_TYPE_UNSIGNED) == 0;
+			const double v = isSigned && bits < 32 && (value & (1u << (bits - 1))) ? (double)value - (double)(1u << bits) : (double)value;
+			if (type & ATTRIBUTE_TYPE_NORMALIZED)
+				return isSigned ? std::max(v / ((1 << (bits - 1)) - 1), -1.) : v / ((1u << bits) - 1);
+			return v;
+		}
+
+		/** quantize the four blend weights to normalized unsigned integers which sum up to exactly the maximum value, 
+		 * by distributing the remainder over the weights with the largest rounding error. A vertex without influences gets
+		 * the full weight on its first blend index. Returns the maximum error. */
+		static float encodeWeights(const unsigned short &type, const float * const &weights, unsigned int (&out)[4]) {
+			const unsigned int max = (1u << (Attributes::componentSize(type) * 8)) - 1;
+			double sum = 0.;
+			for (int i = 0; i < 4; i++)
+				sum += std::max(weights[i], 0.f);
+			if (sum <= 0.) {
+				out[0] = max;
+				out[1] = out[2] = out[3] = 0;
+				return 1.f;
+			}
+			double remainders[4];
+			unsigned int total = 0;
+			for (int i = 0; i < 4; i++) {
+				const double scaled = std::max(weights[i], 0.f) / sum * max;
+				out[i] = (unsigned int)floor(scaled);
+				remainders[i] = scaled - out[i];
+				total += out[i];
+			}
+			for (; total < max; total++) {
+				int largest = 0;
+				for (int i = 1; i < 4; i++)
+					if (remainders[i] > remainders[largest])
+						largest = i;
+				out[largest]++;
+				remainders[largest] -= 1.;
+			}
+			float error = 0.f;
+			for (int i = 0; i < 4; i++)
+				error = std::max(error, (float)fabs((double)out[i] / max - weights[i]));
+			return error;
+		}
+
+		/** convert the value to a 16-bit floating point number (rounded to nearest even) */
+		static unsigned short floatToHalf(const float &value) {
+			unsigned int f;
+			memcpy(&f, &value, sizeof(f));
+			const unsigned int sign = (f >> 16) & 0x8000;
+			const int exponent = (int)((f >> 23) & 0xFF) - 127 + 15;
+			unsigned int mantissa = f & 0x7FFFFF;
+			if (((f >> 23) & 0xFF) == 0xFF)
+				return (unsigned short)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+			if (exponent >= 31)
+				return (unsigned short)(sign | 0x7C00);
+			if (exponent <= 0) {
+				if (exponent < -10)
+					return (unsigned short)sign;
+				mantissa |= 0x800000;
+				const unsigned int shift = (unsigned int)(14 - exponent);
+				unsigned int result = mantissa >> shift;
+				const unsigned int rest = mantissa & ((1u << shift) - 1), half = 1u << (shift - 1);
+				if (rest > half || (rest == half && (result & 1)))
+					result++;
+				return (unsigned short)(sign | result);
+			}
+			unsigned int result = ((unsigned int)exponent << 10) | (mantissa >> 13);
+			const unsigned int rest = mantissa & 0x1FFF;
+			if (rest > 0x1000 || (rest == 0x1000 && (result & 1)))
+				result++;
+			return (unsigned short)(sign | result);
+		}
+
+		/** convert the 16-bit floating point number to a float */
+		static float halfToFloat(const unsigned short &value) {
+			const unsigned int sign = (value & 0x8000) << 16;
+			const unsigned int exponent = (value >> 10) & 0x1F;
+			const unsigned int mantissa = value & 0x3FF;
+			unsigned int result;
+			if (exponent == 0) {
+				const float f = (float)mantissa / (float)(1 << 24);
+				return sign ? -f : f;
+			}
+			else if (exponent == 31)
+				result = sign | 0x7F800000 | (mantissa << 13);
+			else
+				result = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+			float f;
+			memcpy(&f, &result, sizeof(f));
+			return f;
+		}
+
+		/** write the integer representation of the component as little endian, returns the destination of the next component */
+		static unsigned char *writeComponent(unsigned char *dest, const unsigned short &type, const unsigned int &value) {
+			const unsigned int size = Attributes::componentSize(type);
+			for (unsigned int i = 0; i < size; i++)
+				*(dest++) = (unsigned char)((value >> (8 * i)) & 0xFF);
+			return dest;
 		}
 
 		inline unsigned int calcHash(const float *vertex, const unsigned int size) {
@@ -34,13 +34,26 @@ namespace fbxconv {
 namespace modeldata {
 	struct MeshPart : public json::ConstSerializable {
 		std::string id;
-		std::vector<unsigned short> indices;
+		std::vector<unsigned int> indices;
 		unsigned int primitiveType;
+		/** the size in bits (16 or 32) used to serialize the indices */
+		unsigned int indexWidth;
 		std::vector<FbxCluster *> sourceBones;
+		/** the bounds (minU, minV, maxU, maxV) of the texture coordinates of each uv set, if known */
+		std::vector<float> uvBounds;
+		/** the dequantization of the encoded texture coordinates of each uv set (offsetU, offsetV, scaleU, scaleV): uv = offset + scale * value */
+		std::vector<float> uvTransforms;
+		/** the indices compressed with the index codec (see IndexCodec), serialized instead of the indices if not empty */
+		std::vector<unsigned char> encodedIndices;
+		/** the color (r, g, b, a) of all vertices if the color attribute is removed because it's constant, empty otherwise */
+		std::vector<float> constantColor;
+		/** if not zero, the binormals are removed because they can be calculated as: binormal = binormalSign * cross(normal, tangent) */
+		int binormalSign;
 
-		MeshPart() : primitiveType(0) {}
+		MeshPart() : primitiveType(0), indexWidth(16), binormalSign(0) {}
 
-		MeshPart(const MeshPart &copyFrom) {
+		MeshPart(const MeshPart &copyFrom) : indexWidth(copyFrom.indexWidth), uvBounds(copyFrom.uvBounds), uvTransforms(copyFrom.uvTransforms), encodedIndices(copyFrom.encodedIndices),
+				constantColor(copyFrom.constantColor), binormalSign(copyFrom.binormalSign) {
 			set(copyFrom.id.c_str(), copyFrom.primitiveType, copyFrom.indices);
 		}
 
@@ -54,7 +67,7 @@ namespace modeldata {
 			primitiveType = 0;
 		}
 
-		void set(const char *id, const unsigned int &primitiveType, const std::vector<unsigned short> &indices) {
+		void set(const char *id, const unsigned int &primitiveType, const std::vector<unsigned int> &indices) {
 			this->id = id;
 			this->primitiveType = primitiveType;
 			this->indices.clear();
@@ -41,6 +41,8 @@ namespace modeldata {
 		std::vector<Material *> materials;
 		std::vector<Mesh *> meshes;
 		std::vector<Node *> nodes;
+		/** The file (relative to the model file) containing the animations of the model, if they are stored separately */
+		std::string animationBank;
 
 		Model() { version[0] = VERSION_HI; version[1] = VERSION_LO; }
 
@@ -48,6 +50,7 @@ namespace modeldata {
 			version[0] = copyFrom.version[0];
 			version[1] = copyFrom.version[1];
 			id = copyFrom.id;
+			animationBank = copyFrom.animationBank;
 			for (std::vector<Animation *>::const_iterator itr = copyFrom.animations.begin(); itr != copyFrom.animations.end(); ++itr)
 				animations.push_back(new Animation(**itr));
 			for (std::vector<Material *>::const_iterator itr = copyFrom.materials.begin(); itr != copyFrom.materials.end(); ++itr)
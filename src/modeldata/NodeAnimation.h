@@ -32,14 +32,20 @@ namespace modeldata {
 		const Node *node;
 		std::vector<Keyframe *> keyframes;
 		bool translate, rotate, scale;
+		/** the time (in milliseconds) between the samples of the animation */
+		float frameTime;
+		/** the keyframes encoded with the track codec (see TrackCodec), serialized instead of the keyframes if not empty */
+		std::vector<unsigned char> encodedKeyframes;
 
-		NodeAnimation() : node(0), translate(false), rotate(false), scale(false) {}
+		NodeAnimation() : node(0), translate(false), rotate(false), scale(false), frameTime(0.f) {}
 
 		NodeAnimation(const NodeAnimation &copyFrom) {
 			node = copyFrom.node;
 			translate = copyFrom.translate;
 			rotate = copyFrom.rotate;
 			scale = copyFrom.scale;
+			frameTime = copyFrom.frameTime;
+			encodedKeyframes = copyFrom.encodedKeyframes;
 			for (std::vector<Keyframe *>::const_iterator itr = copyFrom.keyframes.begin(); itr != copyFrom.keyframes.end(); ++itr)
 				keyframes.push_back(new Keyframe(*(*itr)));
 		}
@@ -24,6 +24,9 @@
 #include "MeshPart.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "IndexCodec.h"
+#include "VertexCodec.h"
+#include "TrackCodec.h"
 
 namespace fbxconv {
 namespace modeldata {
@@ -80,14 +83,36 @@ void Model::serialize(json::BaseJSONWriter &writer) const {
 	writer << "materials" = materials;
 	writer << "nodes" = nodes;
 	writer << "animations" = animations;
+	if (!animationBank.empty())
+		writer << "animationBank" = animationBank;
 	writer.end();
 }
 
 void Mesh::serialize(json::BaseJSONWriter &writer) const {
-	writer.obj(3);
-    writer << "name" = _name;
+	if (_encodedVertices.empty()) {
+		writer.obj(3);
+		writer << "name" = _name;
+		writer << "attributes" = _attributes;
+		writer.val("vertices").is().data(_vertices, _vertexSize);
+		writer << "parts" = _parts;
+		writer.end();
+		return;
+	}
+	writer.obj(9);
+	writer << "name" = _name;
 	writer << "attributes" = _attributes;
-	writer.val("vertices").is().data(_vertices, _vertexSize);
+	writer << "attributeTypes" = Attributes::TypeDescriptors(_attributes);
+	writer << "vertexStride" = _vertexStride;
+	if (_attributes.hasPosition() && (_attributes.types[ATTRIBUTE_POSITION] & ATTRIBUTE_TYPE_NORMALIZED)) {
+		writer << "positionOffset" = _positionOffset;
+		writer << "positionScale" = _positionScale;
+	}
+	if (!_compressedVertices.empty()) {
+		writer << "vertexCodec" = VERTEXCODEC_NAME;
+		writer.val("vertices").is().data(_compressedVertices, 16);
+	}
+	else
+		writer.val("vertices").is().data(_encodedVertices, _vertexStride);
 	writer << "parts" = _parts;
 	writer.end();
 }
@@ -100,11 +125,48 @@ void Attributes::serialize(json::BaseJSONWriter &writer) const {
 	writer.end();
 }
 
+void Attributes::TypeDescriptors::serialize(json::BaseJSONWriter &writer) const {
+	const unsigned int len = attributes.length();
+	writer.arr(len);
+	for (unsigned int i = 0; i < len; i++) {
+		const int a = attributes.get(i);
+		const unsigned short &type = attributes.types[a];
+		writer.obj(3);
+		// Packed colors are four normalized bytes (RGBA), stored in the bits of a float
+		if (a == ATTRIBUTE_COLORPACKED && type == ATTRIBUTE_TYPE_FLOAT) {
+			writer << "type" = Attributes::typeName(ATTRIBUTE_TYPE_UNORM8);
+			writer << "components" = 4;
+		}
+		else {
+			writer << "type" = Attributes::typeName(type);
+			writer << "components" = attributes.componentCount(a);
+		}
+		writer << "offset" = attributes.encodedOffset(a);
+		writer.end();
+	}
+	writer.end();
+}
+
 void MeshPart::serialize(json::BaseJSONWriter &writer) const {
 	writer.obj(3);
 	writer << "id" = id;
 	writer << "type" = getPrimitiveTypeString(primitiveType);
-	writer.val("indices").is().data(indices, 12);
+	if (!encodedIndices.empty()) {
+		writer << "indexCodec" = INDEXCODEC_NAME;
+		writer.val("indices").is().data(encodedIndices, 16);
+	}
+	else if (indexWidth > 16)
+		writer.val("indices").is().data(indices, 12);
+	else {
+		std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+		writer.val("indices").is().data(shortIndices, 12);
+	}
+	if (!uvTransforms.empty())
+		writer.val("uvTransforms").is().data(uvTransforms, 4);
+	if (!constantColor.empty())
+		writer.val("constantColor").is().data(constantColor, 4);
+	if (binormalSign != 0)
+		writer << "binormalSign" = binormalSign;
 	writer << json::end;
 }
 
@@ -195,6 +257,8 @@ void NodePart::serialize(json::BaseJSONWriter &writer) const {
 void Animation::serialize(json::BaseJSONWriter &writer) const {
 	writer.obj(2);
 	writer << "id" = id;
+	if (loop)
+		writer << "loop" = loop;
 	writer << "bones" = nodeAnimations;
 	writer.end();
 }
@@ -202,7 +266,12 @@ void Animation::serialize(json::BaseJSONWriter &writer) const {
 void NodeAnimation::serialize(json::BaseJSONWriter &writer) const {
 	writer.obj(2);
 	writer << "boneId" = node->id;
-	writer << "keyframes" = keyframes;
+	if (!encodedKeyframes.empty()) {
+		writer << "keyframeCodec" = TRACKCODEC_NAME;
+		writer.val("keyframes").is().data(encodedKeyframes, 16);
+	}
+	else
+		writer << "keyframes" = keyframes;
 	writer.end();
 }
 
@@ -215,6 +284,12 @@ void Keyframe::serialize(json::BaseJSONWriter &writer) const {
 		writer << "scale" = scale;
 	if (hasTranslation)
 		writer << "translation" = translation;
+	if (hasTangents && hasRotation)
+		writer << "rotationTangent" = rotationTangent;
+	if (hasTangents && hasScale)
+		writer << "scaleTangent" = scaleTangent;
+	if (hasTangents && hasTranslation)
+		writer << "translationTangent" = translationTangent;
 	writer << json::end;
 }
 
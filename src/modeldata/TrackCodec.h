@@ -0,0 +1,247 @@
+/*******************************************************************************
+ * Copyright 2011 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+/** @author Xoppa */
+#ifdef _MSC_VER
+#pragma once
+#endif
+#ifndef MODELDATA_TRACKCODEC_H
+#define MODELDATA_TRACKCODEC_H
+
+#include <vector>
+#include <map>
+#include <math.h>
+#include <string.h>
+#include "Keyframe.h"
+
+#define TRACKCODEC_NAME			"track1"
+#define TRACKCODEC_TRANSLATION	0
+#define TRACKCODEC_ROTATION		1
+#define TRACKCODEC_SCALE		2
+#define TRACKCODEC_SQRT2		1.4142135623730951
+
+namespace fbxconv {
+namespace modeldata {
+	/** Stores the keyframes of a node animation as a track per channel (translation, rotation and scale, in that order).
+	 * All numbers are little endian. The data starts with the duration of a frame in milliseconds (float32), followed by each track:
+	 *   uint16 key count (0 if the channel isn't animated), uint8 flags (1: the keys have tangents), uint16 frame index of each key,
+	 *   the values of the keys and, if the keys have tangents, the tangents of the keys.
+	 * Rotations are stored as 48 bits per key (smallest three): bits 0-44 are the three smallest components (15 bits each, mapped
+	 * from [-1/sqrt(2), 1/sqrt(2)]), bits 45-46 the index of the largest component (which is reconstructed as a positive value) and
+	 * bit 47 is set if the quaternion must be negated afterwards, so the sign of each key (and with that its tangent) is preserved.
+	 * Other values (translations, scales and tangents) are stored relative to the range of the track: float32 minimum and maximum
+	 * of each component, followed by an uint16 per component per key: value = min + (max - min) * q / 65535. */
+	class TrackCodec {
+	public:
+		/** Encode the keyframes, the key times are rounded to a multiple of the frame time (in milliseconds).
+		 * Returns false if a key time doesn't fit in 16 bits or a track has more than 65535 keys. */
+		static bool encode(const std::vector<Keyframe *> &keyframes, const float &frameTime, std::vector<unsigned char> &out) {
+			out.clear();
+			if (!(frameTime > 0.f))
+				return false;
+			writeFloat(out, frameTime);
+			for (int c = 0; c < 3; c++) {
+				std::vector<const Keyframe *> keys;
+				for (std::vector<Keyframe *>::const_iterator itr = keyframes.begin(); itr != keyframes.end(); ++itr)
+					if (has(**itr, c))
+						keys.push_back(*itr);
+				if (keys.size() > 0xFFFF)
+					return false;
+				const bool tangents = !keys.empty() && keys[0]->hasTangents;
+				writeShort(out, (unsigned int)keys.size());
+				out.push_back(tangents ? 1 : 0);
+				for (std::vector<const Keyframe *>::const_iterator itr = keys.begin(); itr != keys.end(); ++itr) {
+					const double frame = floor((*itr)->time / frameTime + 0.5);
+					if (frame < 0. || frame > 65535.)
+						return false;
+					writeShort(out, (unsigned int)frame);
+				}
+				if (c == TRACKCODEC_ROTATION)
+					for (std::vector<const Keyframe *>::const_iterator itr = keys.begin(); itr != keys.end(); ++itr)
+						writeRotation(out, (*itr)->rotation);
+				else
+					writeRange(out, keys, c, false);
+				if (tangents)
+					writeRange(out, keys, c, true);
+			}
+			return true;
+		}
+
+		/** Decode the data to keyframes (one for each frame index used by any of the tracks), returns false if the data is malformed.
+		 * This is the reference decoder for the c3db track codec. */
+		static bool decode(const unsigned char * const &data, const unsigned int &size, std::vector<Keyframe> &keyframes) {
+			keyframes.clear();
+			unsigned int pos = 0;
+			if (size < 4)
+				return false;
+			const float frameTime = readFloat(data, pos);
+			std::map<unsigned int, Keyframe> frames;
+			for (int c = 0; c < 3; c++) {
+				if (pos + 3 > size)
+					return false;
+				const unsigned int count = readShort(data, pos);
+				const bool tangents = (data[pos++] & 1) != 0;
+				const unsigned int components = componentCount(c);
+				const unsigned int valueSize = c == TRACKCODEC_ROTATION ? 6 * count : 8 * components + 2 * components * count;
+				if (pos + 2 * count + valueSize + (tangents ? 8 * components + 2 * components * count : 0) > size)
+					return false;
+				std::vector<Keyframe *> keys(count);
+				for (unsigned int i = 0; i < count; i++) {
+					const unsigned int frame = readShort(data, pos);
+					Keyframe &keyframe = frames[frame];
+					keyframe.time = frame * frameTime;
+					keyframe.hasTranslation |= c == TRACKCODEC_TRANSLATION;
+					keyframe.hasRotation |= c == TRACKCODEC_ROTATION;
+					keyframe.hasScale |= c == TRACKCODEC_SCALE;
+					keyframe.hasTangents |= tangents;
+					keys[i] = &keyframe;
+				}
+				if (c == TRACKCODEC_ROTATION)
+					for (unsigned int i = 0; i < count; i++)
+						readRotation(data, pos, keys[i]->rotation);
+				else
+					readRange(data, pos, keys, c, false);
+				if (tangents)
+					readRange(data, pos, keys, c, true);
+			}
+			for (std::map<unsigned int, Keyframe>::const_iterator itr = frames.begin(); itr != frames.end(); ++itr)
+				keyframes.push_back(itr->second);
+			return pos == size;
+		}
+
+	private:
+		static inline bool has(const Keyframe &keyframe, const int &channel) {
+			return channel == TRACKCODEC_TRANSLATION ? keyframe.hasTranslation : (channel == TRACKCODEC_ROTATION ? keyframe.hasRotation : keyframe.hasScale);
+		}
+
+		static inline unsigned int componentCount(const int &channel) {
+			return channel == TRACKCODEC_ROTATION ? 4 : 3;
+		}
+
+		static inline float *get(Keyframe &keyframe, const int &channel, const bool &tangent) {
+			switch (channel) {
+			case TRACKCODEC_TRANSLATION: return tangent ? keyframe.translationTangent : keyframe.translation;
+			case TRACKCODEC_ROTATION: return tangent ? keyframe.rotationTangent : keyframe.rotation;
+			default: return tangent ? keyframe.scaleTangent : keyframe.scale;
+			}
+		}
+
+		static inline const float *get(const Keyframe &keyframe, const int &channel, const bool &tangent) {
+			return get(const_cast<Keyframe &>(keyframe), channel, tangent);
+		}
+
+		static void writeRange(std::vector<unsigned char> &out, const std::vector<const Keyframe *> &keys, const int &channel, const bool &tangent) {
+			const unsigned int n = componentCount(channel);
+			float min[4], max[4];
+			for (unsigned int j = 0; j < n; j++) {
+				min[j] = max[j] = keys.empty() ? 0.f : get(*keys[0], channel, tangent)[j];
+				for (std::vector<const Keyframe *>::const_iterator itr = keys.begin(); itr != keys.end(); ++itr) {
+					const float &v = get(**itr, channel, tangent)[j];
+					min[j] = v < min[j] ? v : min[j];
+					max[j] = v > max[j] ? v : max[j];
+				}
+				writeFloat(out, min[j]);
+				writeFloat(out, max[j]);
+			}
+			for (std::vector<const Keyframe *>::const_iterator itr = keys.begin(); itr != keys.end(); ++itr)
+				for (unsigned int j = 0; j < n; j++) {
+					const double range = (double)max[j] - min[j];
+					writeShort(out, range > 0. ? (unsigned int)floor((get(**itr, channel, tangent)[j] - min[j]) / range * 65535. + 0.5) : 0);
+				}
+		}
+
+		static void readRange(const unsigned char * const &data, unsigned int &pos, const std::vector<Keyframe *> &keys, const int &channel, const bool &tangent) {
+			const unsigned int n = componentCount(channel);
+			float min[4], max[4];
+			for (unsigned int j = 0; j < n; j++) {
+				min[j] = readFloat(data, pos);
+				max[j] = readFloat(data, pos);
+			}
+			for (std::vector<Keyframe *>::const_iterator itr = keys.begin(); itr != keys.end(); ++itr)
+				for (unsigned int j = 0; j < n; j++)
+					get(**itr, channel, tangent)[j] = (float)(min[j] + ((double)max[j] - min[j]) * readShort(data, pos) / 65535.);
+		}
+
+		static void writeRotation(std::vector<unsigned char> &out, const float * const &rotation) {
+			double q[4], length = 0.;
+			for (int i = 0; i < 4; i++)
+				length += (double)rotation[i] * rotation[i];
+			length = length > 0. ? 1. / sqrt(length) : 0.;
+			int largest = 0;
+			for (int i = 0; i < 4; i++) {
+				q[i] = rotation[i] * length;
+				if (fabs(q[i]) > fabs(q[largest]))
+					largest = i;
+			}
+			const bool negate = q[largest] < 0.;
+			unsigned long long bits = ((unsigned long long)largest << 45) | ((negate ? 1ULL : 0ULL) << 47);
+			for (int i = 0, j = 0; i < 4; i++) {
+				if (i == largest)
+					continue;
+				const double v = (negate ? -q[i] : q[i]) * TRACKCODEC_SQRT2 * 0.5 + 0.5;
+				bits |= (unsigned long long)floor((v < 0. ? 0. : (v > 1. ? 1. : v)) * 32767. + 0.5) << (15 * j++);
+			}
+			for (int i = 0; i < 6; i++)
+				out.push_back((unsigned char)(bits >> (8 * i)));
+		}
+
+		static void readRotation(const unsigned char * const &data, unsigned int &pos, float * const &rotation) {
+			unsigned long long bits = 0;
+			for (int i = 0; i < 6; i++)
+				bits |= (unsigned long long)data[pos++] << (8 * i);
+			const int largest = (int)((bits >> 45) & 3);
+			const double sign = ((bits >> 47) & 1) ? -1. : 1.;
+			double sum = 0., q[4];
+			for (int i = 0, j = 0; i < 4; i++) {
+				if (i == largest)
+					continue;
+				q[i] = (((bits >> (15 * j++)) & 0x7FFF) / 32767. - 0.5) * 2. / TRACKCODEC_SQRT2;
+				sum += q[i] * q[i];
+			}
+			q[largest] = sqrt(sum < 1. ? 1. - sum : 0.);
+			for (int i = 0; i < 4; i++)
+				rotation[i] = (float)(sign * q[i]);
+		}
+
+		static inline void writeShort(std::vector<unsigned char> &out, const unsigned int &value) {
+			out.push_back((unsigned char)value);
+			out.push_back((unsigned char)(value >> 8));
+		}
+
+		static inline unsigned int readShort(const unsigned char * const &data, unsigned int &pos) {
+			const unsigned int result = data[pos] | (data[pos + 1] << 8);
+			pos += 2;
+			return result;
+		}
+
+		static inline void writeFloat(std::vector<unsigned char> &out, const float &value) {
+			unsigned int bits;
+			memcpy(&bits, &value, 4);
+			for (int i = 0; i < 4; i++)
+				out.push_back((unsigned char)(bits >> (8 * i)));
+		}
+
+		static inline float readFloat(const unsigned char * const &data, unsigned int &pos) {
+			unsigned int bits = 0;
+			for (int i = 0; i < 4; i++)
+				bits |= (unsigned int)data[pos++] << (8 * i);
+			float result;
+			memcpy(&result, &bits, 4);
+			return result;
+		}
+	};
+} }
+
+#endif //MODELDATA_TRACKCODEC_H
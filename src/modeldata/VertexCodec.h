@@ -0,0 +1,151 @@
+/*******************************************************************************
+ * Copyright 2011 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+/** @author Xoppa */
+#ifdef _MSC_VER
+#pragma once
+#endif
+#ifndef MODELDATA_VERTEXCODEC_H
+#define MODELDATA_VERTEXCODEC_H
+
+#include <vector>
+#include <string.h>
+
+#define VERTEXCODEC_NAME		"delta1"
+#define VERTEXCODEC_BLOCK_BYTES	8192
+#define VERTEXCODEC_GROUP		16
+
+namespace fbxconv {
+namespace modeldata {
+	/** Compresses a vertex stream (count vertices of stride bytes) by transposing it into byte planes and storing the delta
+	 * of each byte to the same byte of the previous vertex.
+	 * The vertices are split in blocks of at most VERTEXCODEC_BLOCK_BYTES bytes (a multiple of VERTEXCODEC_GROUP vertices). For each
+	 * byte of the vertex, a block contains the zigzag encoded deltas in groups of 16: first a header with 2 bits per group (4 groups per
+	 * byte, lowest bits first) that specifies the size of each delta in the group (0: all zero, 1: 2 bits, 2: 4 bits, 3: 8 bits),
+	 * followed by the bit packed deltas of the groups (lowest bits first). The last group of a block is padded with zero deltas.
+	 * Each group decodes to 16 bytes with a fixed width, so a decoder can expand a group with a single table driven shuffle. */
+	class VertexCodec {
+	public:
+		/** the number of vertices per block for the specified stride */
+		static unsigned int blockSize(const unsigned int &stride) {
+			const unsigned int result = (VERTEXCODEC_BLOCK_BYTES / (stride > 0 ? stride : 1)) & ~(VERTEXCODEC_GROUP - 1);
+			return result < VERTEXCODEC_GROUP ? VERTEXCODEC_GROUP : (result > 256 ? 256 : result);
+		}
+
+		static void encode(const unsigned char * const &vertices, const unsigned int &count, const unsigned int &stride, std::vector<unsigned char> &out) {
+			out.clear();
+			std::vector<unsigned char> last(stride, 0);
+			unsigned char deltas[256];
+			const unsigned int size = blockSize(stride);
+			for (unsigned int first = 0; first < count; first += size) {
+				const unsigned int n = count - first < size ? count - first : size;
+				const unsigned int groups = (n + VERTEXCODEC_GROUP - 1) / VERTEXCODEC_GROUP;
+				for (unsigned int k = 0; k < stride; k++) {
+					memset(deltas, 0, sizeof(deltas));
+					unsigned char previous = last[k];
+					for (unsigned int i = 0; i < n; i++) {
+						const unsigned char value = vertices[(first + i) * stride + k];
+						const unsigned char delta = (unsigned char)(value - previous);
+						deltas[i] = (unsigned char)((delta << 1) ^ ((signed char)delta >> 7));
+						previous = value;
+					}
+					last[k] = previous;
+
+					const unsigned int header = (unsigned int)out.size();
+					out.resize(header + (groups + 3) / 4, 0);
+					for (unsigned int g = 0; g < groups; g++) {
+						unsigned char max = 0;
+						for (unsigned int i = 0; i < VERTEXCODEC_GROUP; i++)
+							max |= deltas[g * VERTEXCODEC_GROUP + i];
+						const unsigned int mode = max == 0 ? 0 : (max < 4 ? 1 : (max < 16 ? 2 : 3));
+						out[header + g / 4] |= (unsigned char)(mode << (2 * (g % 4)));
+						writeGroup(out, &deltas[g * VERTEXCODEC_GROUP], mode);
+					}
+				}
+			}
+		}
+
+		/** Decode the data to count vertices of stride bytes, returns false if the data is malformed. This is the reference decoder for the c3db vertex codec. */
+		static bool decode(const unsigned char * const &data, const unsigned int &size, const unsigned int &count, const unsigned int &stride, std::vector<unsigned char> &vertices) {
+			vertices.resize(count * stride);
+			std::vector<unsigned char> last(stride, 0);
+			unsigned char deltas[256];
+			const unsigned int block = blockSize(stride);
+			unsigned int pos = 0;
+			for (unsigned int first = 0; first < count; first += block) {
+				const unsigned int n = count - first < block ? count - first : block;
+				const unsigned int groups = (n + VERTEXCODEC_GROUP - 1) / VERTEXCODEC_GROUP;
+				for (unsigned int k = 0; k < stride; k++) {
+					const unsigned int header = pos;
+					pos += (groups + 3) / 4;
+					if (pos > size)
+						return false;
+					for (unsigned int g = 0; g < groups; g++)
+						if (!readGroup(data, size, pos, (data[header + g / 4] >> (2 * (g % 4))) & 3, &deltas[g * VERTEXCODEC_GROUP]))
+							return false;
+					unsigned char value = last[k];
+					for (unsigned int i = 0; i < n; i++) {
+						value += (unsigned char)((deltas[i] >> 1) ^ -(deltas[i] & 1));
+						vertices[(first + i) * stride + k] = value;
+					}
+					last[k] = value;
+				}
+			}
+			return pos == size;
+		}
+
+	private:
+		static void writeGroup(std::vector<unsigned char> &out, const unsigned char * const &deltas, const unsigned int &mode) {
+			if (mode == 0)
+				return;
+			if (mode == 3) {
+				out.insert(out.end(), deltas, deltas + VERTEXCODEC_GROUP);
+				return;
+			}
+			const unsigned int bits = mode == 1 ? 2 : 4, perByte = 8 / bits;
+			for (unsigned int i = 0; i < VERTEXCODEC_GROUP; i += perByte) {
+				unsigned char b = 0;
+				for (unsigned int j = 0; j < perByte; j++)
+					b |= (unsigned char)(deltas[i + j] << (j * bits));
+				out.push_back(b);
+			}
+		}
+
+		static bool readGroup(const unsigned char * const &data, const unsigned int &size, unsigned int &pos, const unsigned int &mode, unsigned char * const &deltas) {
+			if (mode == 0) {
+				memset(deltas, 0, VERTEXCODEC_GROUP);
+				return true;
+			}
+			if (mode == 3) {
+				if (pos + VERTEXCODEC_GROUP > size)
+					return false;
+				memcpy(deltas, &data[pos], VERTEXCODEC_GROUP);
+				pos += VERTEXCODEC_GROUP;
+				return true;
+			}
+			const unsigned int bits = mode == 1 ? 2 : 4, perByte = 8 / bits, mask = (1u << bits) - 1;
+			if (pos + VERTEXCODEC_GROUP / perByte > size)
+				return false;
+			for (unsigned int i = 0; i < VERTEXCODEC_GROUP; i += perByte) {
+				const unsigned char b = data[pos++];
+				for (unsigned int j = 0; j < perByte; j++)
+					deltas[i + j] = (unsigned char)((b >> (j * bits)) & mask);
+			}
+			return true;
+		}
+	};
+} }
+
+#endif //MODELDATA_VERTEXCODEC_H
@@ -24,10 +24,20 @@
 #include "../Settings.h"
 #include "Reader.h"
 #include <sstream>
+#include <fstream>
 #include <map>
+#include <set>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
 #include "util.h"
 #include "FbxMeshInfo.h"
+#include "MeshPacker.h"
+#include "../modeldata/IndexCodec.h"
+#include "../modeldata/VertexCodec.h"
+#include "../modeldata/TrackCodec.h"
+#include <time.h>
 #include "../log/log.h"
 
 using namespace fbxconv::modeldata;
@@ -65,6 +75,10 @@ namespace readers {
 		std::map<std::string, TextureFileInfo> textureFiles;
 		std::map<FbxMeshInfo *, std::vector<std::vector<MeshPart *> > > meshParts; //[FbxMeshInfo][materialIndex][boneIndex]
 		std::map<const FbxNode *, Node *> nodeMap;
+		// The mesh info which contains the same geometry and the rigid transform from that geometry to this one
+		std::map<FbxMeshInfo *, std::pair<FbxMeshInfo *, FbxAMatrix> > instances;
+		// The uv set (index in the uvMapping of the mesh info) of each texture coordinate, for meshes of which texture coordinates are removed
+		std::map<const FbxMeshInfo *, std::vector<unsigned int> > reducedUVSets;
 
 		Settings *settings;
 		fbxconv::log::Log *log;
@@ -122,12 +136,8 @@ namespace readers {
 
 			importer->Destroy();
 
-			if (scene) {
-				FbxAxisSystem axis(defaultUpAxis, defaultFrontAxis, defaultCoordSystem);
-				axis.ConvertScene(scene);
-			}
 			if (scene)
-				checkNodes();
+				prepareScene(scene, true);
 			if (scene)
 				prefetchMeshes();
 			if (scene)
@@ -143,23 +153,44 @@ namespace readers {
 			_manager->Destroy();
 		}
 
-		/** Check all the nodes within the scene for any incompatibility issues. */
-		void checkNodes() {
-			FbxNode * root = scene->GetRootNode();
+		/** Convert the scene to the default axis system and check all its nodes for any incompatibility issues.
+		 * Only the issues of the loaded scene are reported, not those of the copies used to sample the animations. */
+		void prepareScene(FbxScene * const &target, const bool &report) {
+			FbxAxisSystem axis(defaultUpAxis, defaultFrontAxis, defaultCoordSystem);
+			axis.ConvertScene(target);
+			FbxNode * root = target->GetRootNode();
 			for (int i = 0; i < root->GetChildCount(); i++)
-				checkNode(root->GetChild(i));
+				checkNode(root->GetChild(i), report);
 		}
 
 		/** Recursively check the node for any incompatibility issues. */
-		void checkNode(FbxNode * const &node) {
+		void checkNode(FbxNode * const &node, const bool &report) {
 			FbxTransform::EInheritType inheritType;
 			node->GetTransformationInheritType(inheritType);
 			if (inheritType == FbxTransform::eInheritRrSs) {
-				log->warning(log::wSourceLoadFbxNodeRrSs, node->GetName());
+				if (report)
+					log->warning(log::wSourceLoadFbxNodeRrSs, node->GetName());
 				node->SetTransformationInheritType(FbxTransform::eInheritRSrs);
 			}
 			for (int i = 0; i < node->GetChildCount(); i++)
-				checkNode(node->GetChild(i));
+				checkNode(node->GetChild(i), report);
+		}
+
+		/** Import another copy of the input file using the specified manager, prepared like the loaded scene. Returns 0 on failure. */
+		FbxScene *importScene(FbxManager * const &manager) {
+			manager->SetIOSettings(FbxIOSettings::Create(manager, IOSROOT));
+			manager->GetIOSettings()->SetBoolProp(IMP_FBX_GLOBAL_SETTINGS, true);
+			FbxImporter * const importer = FbxImporter::Create(manager, "");
+			FbxScene *result = 0;
+			if (importer->Initialize(settings->inFile.c_str(), -1, manager->GetIOSettings())) {
+				result = FbxScene::Create(manager, "__FBX_SCENE__");
+				if (!importer->Import(result))
+					result = 0;
+			}
+			importer->Destroy();
+			if (result)
+				prepareScene(result, false);
+			return result;
 		}
 
 		virtual bool convert(Model * const &model) {
@@ -182,13 +213,25 @@ namespace readers {
 			for (std::vector<Node *>::iterator itr = model->nodes.begin(); itr != model->nodes.end(); ++itr)
 				updateNode(model, *itr);
 
+			if (settings->staticBatch && !staticBatch(model))
+				return false;
+			setIndexWidths(model);
+			encodeVertices(model);
+			if (settings->indexCodec)
+				encodeIndices(model);
+			if (settings->vertexCodec)
+				compressVertices(model);
+
 			for (std::map<std::string, Material *>::iterator it = _materialsMap.begin(); it != _materialsMap.end(); ++it) {
 				model->materials.push_back(it->second);
 				for (std::vector<Material::Texture *>::iterator tt = it->second->textures.begin(); tt != it->second->textures.end(); ++tt)
 					(*tt)->path = textureFiles[(*tt)->path].path;
 			}
 
-			addAnimations(model, scene);
+			if (!addAnimations(model, scene))
+				return false;
+			if (settings->animCodec)
+				encodeAnimations(model);
 			return true;
 		}
 
@@ -223,9 +266,18 @@ namespace readers {
 			set<4>(node->transform.rotation, m.GetQ().mData);
 			set<3>(node->transform.scale, m.GetS().mData);
 
+			Node *instance = 0;
 			if (_fbxMeshMap.find(node->source->GetGeometry()) != _fbxMeshMap.end()) {
 				FbxMeshInfo *meshInfo = _fbxMeshMap[node->source->GetGeometry()];
 				std::vector<std::vector<MeshPart *> > &parts = meshParts[meshInfo];
+				// The geometry is a rotated and/or translated copy of another geometry, add a child node containing that transform
+				Node *target = node;
+				if (instances.find(meshInfo) != instances.end() && !isIdentity(instances[meshInfo].second)) {
+					const FbxAMatrix &transform = instances[meshInfo].second;
+					target = instance = new Node((node->id + "_instance").c_str());
+					set<3>(instance->transform.translation, transform.GetT().mData);
+					set<4>(instance->transform.rotation, transform.GetQ().mData);
+				}
 				const int matCount = node->source->GetMaterialCount();
 				if (parts.size() > 0 && matCount < parts.size())
 					log->warning(log::wSourceConvertFbxNoPartMaterial, node->id.c_str(), parts.size() - matCount);
@@ -234,7 +286,7 @@ namespace readers {
 					for (int j = 0; j < parts[i].size(); j++) {
 						if (parts[i][j]) {
 							NodePart *nodePart = new NodePart();
-							node->parts.push_back(nodePart);
+							target->parts.push_back(nodePart);
 							nodePart->material = material;
 							nodePart->meshPart = parts[i][j];
 							for (int k = 0; k < nodePart->meshPart->sourceBones.size(); k++) {
@@ -249,12 +301,15 @@ namespace readers {
 								}
 							}
 
-							nodePart->uvMapping.resize(meshInfo->uvCount);
-							for (unsigned int k = 0; k < meshInfo->uvCount; k++) {
+							const std::map<const FbxMeshInfo *, std::vector<unsigned int> >::const_iterator uvSets = reducedUVSets.find(meshInfo);
+							const unsigned int uvCount = uvSets != reducedUVSets.end() ? (unsigned int)uvSets->second.size() : meshInfo->uvCount;
+							nodePart->uvMapping.resize(uvCount);
+							for (unsigned int k = 0; k < uvCount; k++) {
+								const std::string &uvSet = meshInfo->uvMapping[uvSets != reducedUVSets.end() ? uvSets->second[k] : k];
 								for (std::vector<Material::Texture *>::iterator it = material->textures.begin(); it != material->textures.end(); ++it) {
 									FbxFileTexture *texture = (*it)->source;
 									TextureFileInfo &info = textureFiles[texture->GetFileName()];
-									if (meshInfo->uvMapping[k] == texture->UVSet.Get().Buffer()) {
+									if (uvSet == texture->UVSet.Get().Buffer()) {
 										nodePart->uvMapping[k].push_back(*it);
 									}
 								}
@@ -266,6 +321,316 @@ namespace readers {
 
 			for (std::vector<Node *>::iterator itr = node->children.begin(); itr != node->children.end(); ++itr)
 				updateNode(model, *itr);
+			if (instance != 0)
+				node->children.push_back(instance);
+		}
+
+		inline static bool isIdentity(const FbxAMatrix &m) {
+			for (int i = 0; i < 4; i++)
+				for (int j = 0; j < 4; j++)
+					if (m.mData[i][j] != (i == j ? 1. : 0.))
+						return false;
+			return true;
+		}
+
+		struct StaticBatch {
+			const Material *material;
+			Attributes attributes;
+			std::vector<std::vector<Material::Texture *> > uvMapping;
+			Mesh *mesh;
+			MeshPart *meshPart;
+		};
+
+		/** Bake the transform of all nodes that aren't animated into the vertices and merge their parts per material, 
+		 * returns false if the nodes to preserve couldn't be read. */
+		bool staticBatch(Model * const &model) {
+			std::set<std::string> preserve;
+			if (!settings->preserveNodesFile.empty()) {
+				std::ifstream file(settings->preserveNodesFile.c_str());
+				if (!file.is_open()) {
+					log->error(log::eSourceConvertPreserveNodes, settings->preserveNodesFile.c_str());
+					return false;
+				}
+				std::string line;
+				while (std::getline(file, line)) {
+					const size_t first = line.find_first_not_of(" \t\r");
+					const size_t last = line.find_last_not_of(" \t\r");
+					if (first != std::string::npos && line[first] != '#')
+						preserve.insert(line.substr(first, last - first + 1));
+				}
+			}
+
+			std::set<const FbxNode *> animated;
+			getAnimatedNodes(animated);
+			std::set<const Node *> bones;
+			for (std::vector<Node *>::const_iterator itr = model->nodes.begin(); itr != model->nodes.end(); ++itr)
+				getBones(*itr, bones);
+			std::map<const MeshPart *, Mesh *> partMeshes;
+			for (std::vector<Mesh *>::const_iterator itr = model->meshes.begin(); itr != model->meshes.end(); ++itr)
+				for (std::vector<MeshPart *>::const_iterator it = (*itr)->_parts.begin(); it != (*itr)->_parts.end(); ++it)
+					partMeshes[*it] = *itr;
+
+			std::vector<StaticBatch> batches;
+			std::vector<Mesh *> meshes;
+			std::set<const Node *> emptied;
+			unsigned int partCount = 0, nodeCount = 0;
+			for (std::vector<Node *>::const_iterator itr = model->nodes.begin(); itr != model->nodes.end(); ++itr)
+				staticBatch(*itr, FbxAMatrix(), preserve, animated, partMeshes, batches, meshes, emptied, partCount, nodeCount);
+			if (batches.empty())
+				return true;
+
+			std::stringstream ss;
+			ss << "static_batch";
+			for (int i = 2; model->getNode(ss.str().c_str()); i++) {
+				ss.str("");
+				ss << "static_batch" << i;
+			}
+			Node *batchNode = new Node(ss.str().c_str());
+			for (unsigned int i = 0; i < batches.size(); i++) {
+				std::stringstream id;
+				id << batchNode->id << "_part" << (i + 1);
+				batches[i].meshPart->id = id.str();
+				NodePart *nodePart = new NodePart();
+				nodePart->meshPart = batches[i].meshPart;
+				nodePart->material = batches[i].material;
+				nodePart->uvMapping = batches[i].uvMapping;
+				batchNode->parts.push_back(nodePart);
+			}
+			model->nodes.push_back(batchNode);
+
+			const size_t totalNodeCount = model->getTotalNodeCount();
+			for (int i = (int)model->nodes.size() - 1; i >= 0; --i) {
+				if (pruneNode(model->nodes[i], emptied, preserve, animated, bones)) {
+					delete model->nodes[i];
+					model->nodes.erase(model->nodes.begin() + i);
+				}
+			}
+			removeUnusedMeshParts(model);
+			model->meshes.insert(model->meshes.end(), meshes.begin(), meshes.end());
+			log->verbose(log::iSourceConvertStaticBatch, partCount, nodeCount, (int)batches.size(), (int)(totalNodeCount - model->getTotalNodeCount()));
+			return true;
+		}
+
+		void staticBatch(Node * const &node, const FbxAMatrix &parentTransform, const std::set<std::string> &preserve, const std::set<const FbxNode *> &animated, 
+				std::map<const MeshPart *, Mesh *> &partMeshes, std::vector<StaticBatch> &batches, std::vector<Mesh *> &meshes, 
+				std::set<const Node *> &emptied, unsigned int &partCount, unsigned int &nodeCount) {
+			// The children of an animated node are moved by the animation as well
+			if (animated.find(node->source) != animated.end())
+				return;
+			// Note that the geometric transform isn't exported for the node either, so it isn't baked
+			FbxAMatrix transform;
+			if (node->source != 0)
+				transform = node->source->EvaluateGlobalTransform();
+			else {
+				// Nodes added by the converter itself (e.g. for instances)
+				const float * const &t = node->transform.translation, * const &r = node->transform.rotation, * const &s = node->transform.scale;
+				transform.SetTQS(FbxVector4(t[0], t[1], t[2]), FbxQuaternion(r[0], r[1], r[2], r[3]), FbxVector4(s[0], s[1], s[2]));
+				transform = parentTransform * transform;
+			}
+			for (std::vector<Node *>::const_iterator itr = node->children.begin(); itr != node->children.end(); ++itr)
+				staticBatch(*itr, transform, preserve, animated, partMeshes, batches, meshes, emptied, partCount, nodeCount);
+			if (preserve.find(node->id) != preserve.end() || node->parts.empty())
+				return;
+
+			const FbxVector4 origin = transform.MultT(FbxVector4(0., 0., 0., 1.));
+			double linear[3][3], cofactor[3][3];
+			for (int j = 0; j < 3; j++) {
+				FbxVector4 axis(0., 0., 0., 1.);
+				axis[j] = 1.;
+				const FbxVector4 v = transform.MultT(axis) - origin;
+				for (int i = 0; i < 3; i++)
+					linear[i][j] = v[i];
+			}
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					cofactor[i][j] = linear[(i+1)%3][(j+1)%3] * linear[(i+2)%3][(j+2)%3] - linear[(i+1)%3][(j+2)%3] * linear[(i+2)%3][(j+1)%3];
+			const double det = linear[0][0] * cofactor[0][0] + linear[0][1] * cofactor[0][1] + linear[0][2] * cofactor[0][2];
+			const bool mirror = det < 0.;
+
+			const unsigned int maxVertexCount = (unsigned int)settings->maxVertexCount, maxIndexCount = (unsigned int)settings->maxIndexCount;
+			bool batched = false;
+			for (int p = (int)node->parts.size() - 1; p >= 0; --p) {
+				NodePart * const &nodePart = node->parts[p];
+				if (!nodePart->bones.empty() || nodePart->meshPart->primitiveType != PRIMITIVETYPE_TRIANGLES)
+					continue;
+				const MeshPart * const &meshPart = nodePart->meshPart;
+				Mesh * const &source = partMeshes[meshPart];
+				const unsigned int indexCount = (unsigned int)meshPart->indices.size();
+				StaticBatch *batch = 0;
+				// A mirroring transform flips the handedness of the tangent frame
+				const int binormalSign = mirror ? -meshPart->binormalSign : meshPart->binormalSign;
+				for (std::vector<StaticBatch>::iterator itr = batches.begin(); itr != batches.end(); ++itr)
+					if ((*itr).material == nodePart->material && (*itr).attributes == source->_attributes && (*itr).uvMapping == nodePart->uvMapping && 
+							(*itr).meshPart->constantColor == meshPart->constantColor && (*itr).meshPart->binormalSign == binormalSign &&
+							(*itr).mesh->vertexCount() + indexCount <= maxVertexCount && (*itr).mesh->indexCount() + indexCount <= maxIndexCount)
+						batch = &(*itr);
+				if (batch == 0) {
+					StaticBatch b;
+					b.material = nodePart->material;
+					b.attributes = source->_attributes;
+					b.uvMapping = nodePart->uvMapping;
+					b.mesh = 0;
+					for (std::vector<Mesh *>::iterator itr = meshes.begin(); itr != meshes.end(); ++itr)
+						if ((*itr)->_attributes == source->_attributes && 
+								(*itr)->vertexCount() + indexCount <= maxVertexCount && (*itr)->indexCount() + indexCount <= maxIndexCount)
+							b.mesh = *itr;
+					if (b.mesh == 0) {
+						b.mesh = new Mesh();
+						b.mesh->_name = "static_batch";
+						b.mesh->_attributes = source->_attributes;
+						b.mesh->_vertexSize = source->_vertexSize;
+						meshes.push_back(b.mesh);
+					}
+					b.meshPart = new MeshPart();
+					b.meshPart->primitiveType = PRIMITIVETYPE_TRIANGLES;
+					b.meshPart->constantColor = meshPart->constantColor;
+					b.meshPart->binormalSign = binormalSign;
+					b.mesh->_parts.push_back(b.meshPart);
+					batches.push_back(b);
+					batch = &batches.back();
+				}
+
+				float *vertex = new float[source->_vertexSize];
+				const unsigned int first = (unsigned int)batch->meshPart->indices.size();
+				for (std::vector<unsigned int>::const_iterator itr = meshPart->indices.begin(); itr != meshPart->indices.end(); ++itr) {
+					memcpy(vertex, &source->_vertices[(*itr) * source->_vertexSize], source->_vertexSize * sizeof(float));
+					bakeVertex(vertex, source->_attributes, transform, linear, cofactor, mirror);
+					batch->meshPart->indices.push_back(batch->mesh->add(vertex));
+				}
+				delete[] vertex;
+				// A mirroring transform changes the winding of the triangles
+				if (mirror)
+					for (unsigned int i = first; i + 2 < batch->meshPart->indices.size(); i += 3)
+						std::swap(batch->meshPart->indices[i + 1], batch->meshPart->indices[i + 2]);
+
+				delete nodePart;
+				node->parts.erase(node->parts.begin() + p);
+				partCount++;
+				batched = true;
+			}
+			if (batched) {
+				nodeCount++;
+				if (node->parts.empty())
+					emptied.insert(node);
+			}
+		}
+
+		/** Transform the vertex by the (non-animated) transform, directions are transformed by the linear part and normals by its cofactor matrix. */
+		void bakeVertex(float * const &vertex, const Attributes &attributes, const FbxAMatrix &transform, const double (&linear)[3][3], const double (&cofactor)[3][3], const bool &mirror) {
+			int offset;
+			if ((offset = attributes.offset(ATTRIBUTE_POSITION)) >= 0) {
+				const FbxVector4 v = transform.MultT(FbxVector4(vertex[offset], vertex[offset+1], vertex[offset+2], 1.));
+				set<3>(&vertex[offset], v.mData);
+			}
+			if ((offset = attributes.offset(ATTRIBUTE_NORMAL)) >= 0)
+				transformDirection(&vertex[offset], cofactor, mirror ? -1. : 1.);
+			if ((offset = attributes.offset(ATTRIBUTE_TANGENT)) >= 0)
+				transformDirection(&vertex[offset], linear, 1.);
+			if ((offset = attributes.offset(ATTRIBUTE_BINORMAL)) >= 0)
+				transformDirection(&vertex[offset], linear, 1.);
+			if ((offset = attributes.offset(ATTRIBUTE_QTANGENT)) >= 0) {
+				double normal[3], tangent[3], binormal[3];
+				fromQTangent(&vertex[offset], normal, tangent, binormal);
+				transformDirection(normal, cofactor, mirror ? -1. : 1.);
+				transformDirection(tangent, linear, 1.);
+				transformDirection(binormal, linear, 1.);
+				toQTangent(normal, tangent, binormal, &vertex[offset]);
+			}
+		}
+
+		template<class T> inline static void transformDirection(T * const v, const double (&m)[3][3], const double &sign) {
+			double r[3], len = 0.;
+			for (int i = 0; i < 3; i++) {
+				r[i] = sign * (m[i][0] * v[0] + m[i][1] * v[1] + m[i][2] * v[2]);
+				len += r[i] * r[i];
+			}
+			len = len > 0. ? 1. / sqrt(len) : 0.;
+			for (int i = 0; i < 3; i++)
+				v[i] = (T)(r[i] * len);
+		}
+
+		/** Recursively remove the children of the node whose parts were all moved to a static batch, if they are not needed anymore.
+		 * Returns true if the node itself can be removed, in which case it is removed from the node map as well. */
+		bool pruneNode(Node * const &node, const std::set<const Node *> &emptied, const std::set<std::string> &preserve, 
+				const std::set<const FbxNode *> &animated, const std::set<const Node *> &bones) {
+			for (int i = (int)node->children.size() - 1; i >= 0; --i) {
+				if (pruneNode(node->children[i], emptied, preserve, animated, bones)) {
+					delete node->children[i];
+					node->children.erase(node->children.begin() + i);
+				}
+			}
+			if (emptied.find(node) == emptied.end() || !node->parts.empty() || !node->children.empty() || preserve.find(node->id) != preserve.end() ||
+					animated.find(node->source) != animated.end() || bones.find(node) != bones.end())
+				return false;
+			std::map<const FbxNode *, Node *>::iterator itr = nodeMap.find(node->source);
+			if (itr != nodeMap.end() && itr->second == node)
+				nodeMap.erase(itr);
+			return true;
+		}
+
+		void getBones(const Node * const &node, std::set<const Node *> &bones) {
+			for (std::vector<NodePart *>::const_iterator itr = node->parts.begin(); itr != node->parts.end(); ++itr)
+				for (std::vector<std::pair<Node *, FbxAMatrix> >::const_iterator it = (*itr)->bones.begin(); it != (*itr)->bones.end(); ++it)
+					bones.insert(it->first);
+			for (std::vector<Node *>::const_iterator itr = node->children.begin(); itr != node->children.end(); ++itr)
+				getBones(*itr, bones);
+		}
+
+		/** Collect all nodes of which any property is animated by any of the animation stacks */
+		void getAnimatedNodes(std::set<const FbxNode *> &nodes) {
+			const int stackCount = scene->GetSrcObjectCount<FbxAnimStack>();
+			for (int s = 0; s < stackCount; s++) {
+				FbxAnimStack *animStack = scene->GetSrcObject<FbxAnimStack>(s);
+				const int layerCount = animStack->GetMemberCount<FbxAnimLayer>();
+				for (int l = 0; l < layerCount; l++) {
+					FbxAnimLayer *layer = animStack->GetMember<FbxAnimLayer>(l);
+					const int curveNodeCount = layer->GetSrcObjectCount<FbxAnimCurveNode>();
+					for (int n = 0; n < curveNodeCount; n++) {
+						FbxAnimCurveNode *curveNode = layer->GetSrcObject<FbxAnimCurveNode>(n);
+						const int nc = curveNode->GetDstPropertyCount();
+						for (int o = 0; o < nc; o++) {
+							FbxObject *object = curveNode->GetDstProperty(o).GetFbxObject();
+							if (object && object->Is<FbxNode>())
+								nodes.insert((FbxNode *)object);
+						}
+					}
+				}
+			}
+		}
+
+		/** Remove all mesh parts which aren't referenced by any node part, and the vertices and meshes which aren't used anymore */
+		void removeUnusedMeshParts(Model * const &model) {
+			std::set<const MeshPart *> used;
+			for (std::vector<Node *>::const_iterator itr = model->nodes.begin(); itr != model->nodes.end(); ++itr)
+				getMeshParts(*itr, used);
+			for (std::map<FbxMeshInfo *, std::vector<std::vector<MeshPart *> > >::iterator itr = meshParts.begin(); itr != meshParts.end(); ++itr)
+				for (std::vector<std::vector<MeshPart *> >::iterator it = itr->second.begin(); it != itr->second.end(); ++it)
+					for (std::vector<MeshPart *>::iterator part = (*it).begin(); part != (*it).end(); ++part)
+						if (used.find(*part) == used.end())
+							*part = 0;
+			for (int i = (int)model->meshes.size() - 1; i >= 0; --i) {
+				Mesh * const mesh = model->meshes[i];
+				const size_t partCount = mesh->_parts.size();
+				for (int j = (int)partCount - 1; j >= 0; --j) {
+					if (used.find(mesh->_parts[j]) == used.end()) {
+						delete mesh->_parts[j];
+						mesh->_parts.erase(mesh->_parts.begin() + j);
+					}
+				}
+				if (mesh->_parts.empty()) {
+					delete mesh;
+					model->meshes.erase(model->meshes.begin() + i);
+				}
+				else if (mesh->_parts.size() != partCount)
+					mesh->removeUnusedVertices();
+			}
+		}
+
+		void getMeshParts(const Node * const &node, std::set<const MeshPart *> &parts) {
+			for (std::vector<NodePart *>::const_iterator itr = node->parts.begin(); itr != node->parts.end(); ++itr)
+				parts.insert((*itr)->meshPart);
+			for (std::vector<Node *>::const_iterator itr = node->children.begin(); itr != node->children.end(); ++itr)
+				getMeshParts(*itr, parts);
 		}
 
 		FbxAMatrix convertMatrix(const FbxMatrix& mat)
@@ -305,67 +670,616 @@ namespace readers {
 			out = relinit.Inverse();
 		}
 
-		// Iterate throught the nodes (from the leaves up) and the meshes it references. This might help that meshparts that are closer together are more likely to be merged
-		// Note that in the end this is just another way of adding all items in _meshInfos.
-		void addMesh(Model * const &model, FbxNode * node = 0) {
+		// Create the meshes of all nodes (from the leaves up) and pack them into the fewest meshes (vertex buffers) within the vertex and index limits.
+		// Meshes are merged in order of locality (their position within the hierarchy or the scene, depending on the pack mode), so meshparts that
+		// are closer together are more likely to end up in the same mesh. Instanced geometries share the mesh of the first instance.
+		void addMesh(Model * const &model) {
+			std::vector<std::pair<FbxMeshInfo *, FbxNode *> > meshes;
+			std::vector<double> localities;
+			std::set<FbxMeshInfo *> collected;
+			unsigned int nodeIndex = 0;
+			collectMeshes(meshes, localities, collected, nodeIndex);
+			for (std::vector<double>::iterator itr = localities.begin(); itr != localities.end(); ++itr)
+				*itr /= (double)std::max(nodeIndex, 1U);
+
+			std::vector<Mesh *> created;
+			std::vector<FbxNode *> nodes;
+			std::vector<MeshPackItem> items;
+			std::vector<Mesh *> chunks;
+			std::multimap<unsigned int, std::pair<FbxMeshInfo *, std::vector<Mesh *> > > geometries;
+			for (unsigned int i = 0; i < meshes.size(); i++) {
+				chunks.clear();
+				if (!createMesh(meshes[i].first, meshes[i].second, chunks))
+					continue;
+				if (settings->reduceAttributes)
+					reduceAttributes(meshes[i].first, chunks);
+				if (addInstance(meshes[i].first, chunks, geometries))
+					continue;
+				for (std::vector<Mesh *>::iterator itr = chunks.begin(); itr != chunks.end(); ++itr) {
+					MeshPackItem item;
+					item.vertexCount = (*itr)->vertexCount();
+					item.indexCount = (*itr)->indexCount();
+					item.group = (*itr)->_attributes.value;
+					item.locality = localities[i];
+					created.push_back(*itr);
+					nodes.push_back(meshes[i].second);
+					items.push_back(item);
+				}
+			}
+			if (settings->packMode == PACKMODE_SPATIAL)
+				calculateSpatialLocality(created, nodes, items);
+
+			if (settings->packMode == PACKMODE_NONE) {
+				for (std::vector<Mesh *>::iterator itr = created.begin(); itr != created.end(); ++itr) {
+					Mesh *mesh = findReusableMesh(model, (*itr)->_attributes, (*itr)->vertexCount(), (*itr)->indexCount());
+					if (mesh == 0)
+						model->meshes.push_back(*itr);
+					else {
+						mesh->merge(**itr);
+						delete (*itr);
+					}
+				}
+				reportMeshUtilization(model, (unsigned int)created.size(), 0);
+				return;
+			}
+
+			MeshPacker packer((unsigned int)settings->maxVertexCount, (unsigned int)settings->maxIndexCount);
+			packer.pack(items);
+			// Merge the meshes of each bin in order of locality
+			std::vector<std::vector<std::pair<double, unsigned int> > > bins(packer.bins.size());
+			for (unsigned int i = 0; i < items.size(); i++)
+				bins[items[i].bin].push_back(std::make_pair(items[i].locality, i));
+			for (std::vector<std::vector<std::pair<double, unsigned int> > >::iterator itr = bins.begin(); itr != bins.end(); ++itr) {
+				std::stable_sort((*itr).begin(), (*itr).end());
+				Mesh *mesh = created[(*itr)[0].second];
+				for (unsigned int i = 1; i < (*itr).size(); i++) {
+					mesh->merge(*created[(*itr)[i].second]);
+					delete created[(*itr)[i].second];
+				}
+				model->meshes.push_back(mesh);
+			}
+			reportMeshUtilization(model, (unsigned int)created.size(), packer.lowerBound);
+		}
+
+		/** Remove the attributes of the meshes of the meshInfo that are constant (colors, moved to the mesh parts), that can be calculated 
+		 * from other attributes (binormals) or that no texture uses (texture coordinates). Must be called before the meshes are merged, so 
+		 * merging is based on the reduced attributes. */
+		void reduceAttributes(FbxMeshInfo * const &meshInfo, std::vector<Mesh *> &chunks) {
+			if (chunks.empty())
+				return;
+			const Attributes &attributes = chunks[0]->_attributes;
+			Attributes reduced(attributes);
+			int source[ATTRIBUTE_COUNT];
+			for (unsigned int a = 0; a < ATTRIBUTE_COUNT; a++)
+				source[a] = (int)a;
+			std::string removed;
+			unsigned int before = 0, after = 0;
+			for (std::vector<Mesh *>::const_iterator itr = chunks.begin(); itr != chunks.end(); ++itr)
+				before += (unsigned int)(*itr)->_vertices.size() * 4;
+
+			std::vector<float> color;
+			const int colorAttribute = attributes.hasColor() ? ATTRIBUTE_COLOR : (attributes.hasColorPacked() ? ATTRIBUTE_COLORPACKED : -1);
+			if (colorAttribute >= 0 && getConstantAttribute(chunks, colorAttribute, color)) {
+				reduced.remove(colorAttribute);
+				removed += std::string(removed.empty() ? "" : ", ") + AttributeNames[colorAttribute];
+			}
+
+			const int binormalSign = getBinormalSign(chunks);
+			if (binormalSign != 0) {
+				reduced.hasBinormal(false);
+				removed += std::string(removed.empty() ? "" : ", ") + AttributeNames[ATTRIBUTE_BINORMAL];
+			}
+
+			bool used[8];
+			getUsedUVSets(meshInfo, used);
+			std::vector<unsigned int> uvSets;
+			for (unsigned int k = 0; k < meshInfo->uvCount; k++) {
+				reduced.hasUV(k, false);
+				if (used[k])
+					uvSets.push_back(k);
+				else
+					removed += std::string(removed.empty() ? "" : ", ") + AttributeNames[ATTRIBUTE_TEXCOORD0 + k];
+			}
+			for (unsigned int k = 0; k < uvSets.size(); k++) {
+				reduced.hasUV(k, true);
+				source[ATTRIBUTE_TEXCOORD0 + k] = ATTRIBUTE_TEXCOORD0 + uvSets[k];
+			}
+
+			if (reduced == attributes)
+				return;
+			if (uvSets.size() != meshInfo->uvCount)
+				reducedUVSets[meshInfo] = uvSets;
+			for (std::vector<Mesh *>::iterator itr = chunks.begin(); itr != chunks.end(); ++itr) {
+				(*itr)->setAttributes(reduced, source);
+				after += (unsigned int)(*itr)->_vertices.size() * 4;
+				for (std::vector<MeshPart *>::iterator it = (*itr)->_parts.begin(); it != (*itr)->_parts.end(); ++it) {
+					(*it)->constantColor = color;
+					(*it)->binormalSign = binormalSign;
+					if ((*it)->uvBounds.size() == 4 * meshInfo->uvCount) {
+						std::vector<float> bounds;
+						for (unsigned int k = 0; k < uvSets.size(); k++)
+							bounds.insert(bounds.end(), &(*it)->uvBounds[4 * uvSets[k]], &(*it)->uvBounds[4 * uvSets[k] + 4]);
+						(*it)->uvBounds.swap(bounds);
+					}
+				}
+			}
+			log->verbose(log::iSourceConvertReduceAttributes, meshInfo->id.c_str(), removed.c_str(), before, after);
+		}
+
+		/** Whether the attribute has the same value for all vertices, if so the value (r, g, b, a for colors) is stored in value. */
+		bool getConstantAttribute(const std::vector<Mesh *> &meshes, const int &attribute, std::vector<float> &value) {
+			const float *first = 0;
+			for (std::vector<Mesh *>::const_iterator itr = meshes.begin(); itr != meshes.end(); ++itr) {
+				const int offset = (*itr)->_attributes.offset(attribute);
+				for (unsigned int v = offset; v < (*itr)->_vertices.size(); v += (*itr)->_vertexSize) {
+					if (first == 0)
+						first = &(*itr)->_vertices[v];
+					else if (memcmp(first, &(*itr)->_vertices[v], ATTRIBUTE_SIZE(attribute) * sizeof(float)) != 0)
+						return false;
+				}
+			}
+			if (first == 0)
+				return false;
+			if (attribute == ATTRIBUTE_COLORPACKED) {
+				unsigned int packed;
+				memcpy(&packed, first, sizeof(packed));
+				value.resize(4);
+				for (int i = 0; i < 4; i++)
+					value[i] = (float)((packed >> (8 * i)) & 0xFF) / 255.f;
+			}
+			else
+				value.assign(first, first + ATTRIBUTE_SIZE(attribute));
+			return true;
+		}
+
+		/** The sign s (1 or -1) for which binormal = s * cross(normal, tangent) holds for all vertices, or 0 if there is no such sign. */
+		int getBinormalSign(const std::vector<Mesh *> &meshes) {
+			// The cosine of the maximum angle between the binormal and the calculated binormal
+			static const double tolerance = 0.9999;
+			int result = 0;
+			for (std::vector<Mesh *>::const_iterator itr = meshes.begin(); itr != meshes.end(); ++itr) {
+				const Attributes &attributes = (*itr)->_attributes;
+				if (!attributes.hasNormal() || !attributes.hasTangent() || !attributes.hasBinormal())
+					return 0;
+				const int n = attributes.offset(ATTRIBUTE_NORMAL), t = attributes.offset(ATTRIBUTE_TANGENT), b = attributes.offset(ATTRIBUTE_BINORMAL);
+				for (unsigned int v = 0; v < (*itr)->_vertices.size(); v += (*itr)->_vertexSize) {
+					const float * const vertex = &(*itr)->_vertices[v];
+					double calculated[3], dot = 0., length1 = 0., length2 = 0.;
+					for (int i = 0; i < 3; i++) {
+						calculated[i] = (double)vertex[n+(i+1)%3] * vertex[t+(i+2)%3] - (double)vertex[n+(i+2)%3] * vertex[t+(i+1)%3];
+						dot += calculated[i] * vertex[b+i];
+						length1 += calculated[i] * calculated[i];
+						length2 += (double)vertex[b+i] * vertex[b+i];
+					}
+					if (length1 <= 0. || length2 <= 0.)
+						return 0;
+					const double cosine = dot / sqrt(length1 * length2);
+					const int sign = cosine < 0. ? -1 : 1;
+					if ((result != 0 && sign != result) || cosine * sign < tolerance)
+						return 0;
+					result = sign;
+				}
+			}
+			return result;
+		}
+
+		/** Whether each uv set of the meshInfo is used by a texture of the materials of the nodes using the meshInfo. Textures of which the
+		 * uv set isn't found use the first texture coordinates. */
+		void getUsedUVSets(FbxMeshInfo * const &meshInfo, bool (&used)[8]) {
+			for (int k = 0; k < 8; k++)
+				used[k] = false;
+			const int nodeCount = meshInfo->_mesh->GetNodeCount();
+			for (int n = 0; n < nodeCount; n++) {
+				FbxNode * const node = meshInfo->_mesh->GetNode(n);
+				const int matCount = node->GetMaterialCount();
+				for (int i = 0; i < matCount; i++) {
+					std::map<std::string, Material *>::const_iterator material = _materialsMap.find(node->GetMaterial(i)->GetName());
+					if (material == _materialsMap.end())
+						continue;
+					for (std::vector<Material::Texture *>::const_iterator it = material->second->textures.begin(); it != material->second->textures.end(); ++it) {
+						unsigned int k = 0;
+						while (k < meshInfo->uvCount && meshInfo->uvMapping[k] != (*it)->source->UVSet.Get().Buffer())
+							k++;
+						used[k < meshInfo->uvCount ? k : 0] = true;
+					}
+				}
+			}
+		}
+
+		/** Check if the meshes of the meshInfo contain the same geometry (possibly rigidly transformed) as previously added meshes, if so
+		 * the meshes are deleted and the mesh parts of the previous meshInfo are used instead. Skinned meshes are never shared, because the 
+		 * mesh parts reference the clusters of the skin. */
+		bool addInstance(FbxMeshInfo * const &meshInfo, std::vector<Mesh *> &chunks, std::multimap<unsigned int, std::pair<FbxMeshInfo *, std::vector<Mesh *> > > &geometries) {
+			if (meshInfo->skin)
+				return false;
+			const unsigned int hash = calcGeometryHash(chunks);
+			typedef std::multimap<unsigned int, std::pair<FbxMeshInfo *, std::vector<Mesh *> > >::iterator GeometryIterator;
+			const std::pair<GeometryIterator, GeometryIterator> range = geometries.equal_range(hash);
+			FbxAMatrix transform;
+			for (GeometryIterator itr = range.first; itr != range.second; ++itr) {
+				if (!isInstance(itr->second.first, itr->second.second, meshInfo, chunks, transform))
+					continue;
+				for (std::vector<Mesh *>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+					delete (*it);
+				meshParts[meshInfo] = meshParts[itr->second.first];
+				instances[meshInfo] = std::make_pair(itr->second.first, transform);
+				log->verbose(log::iSourceConvertFbxInstance, meshInfo->id.c_str(), itr->second.first->id.c_str());
+				return true;
+			}
+			geometries.insert(std::make_pair(hash, std::make_pair(meshInfo, chunks)));
+			return false;
+		}
+
+		/** A hash of the geometry which doesn't change when the geometry is rigidly transformed */
+		unsigned int calcGeometryHash(const std::vector<Mesh *> &meshes) {
+			unsigned int result = (unsigned int)meshes.size();
+			for (std::vector<Mesh *>::const_iterator itr = meshes.begin(); itr != meshes.end(); ++itr) {
+				const Mesh * const &mesh = *itr;
+				result = result * 31 + (unsigned int)mesh->_attributes.value;
+				result = result * 31 + (unsigned int)mesh->_vertices.size();
+				for (std::vector<MeshPart *>::const_iterator it = mesh->_parts.begin(); it != mesh->_parts.end(); ++it)
+					for (std::vector<unsigned int>::const_iterator idx = (*it)->indices.begin(); idx != (*it)->indices.end(); ++idx)
+						result = result * 31 + *idx;
+				const unsigned int size = mesh->_vertexSize;
+				for (unsigned int a = 0; a < ATTRIBUTE_COUNT; a++) {
+					const int offset = mesh->_attributes.offset(a);
+					if (offset < 0 || a == ATTRIBUTE_POSITION || a == ATTRIBUTE_NORMAL || a == ATTRIBUTE_TANGENT || a == ATTRIBUTE_BINORMAL || a == ATTRIBUTE_QTANGENT)
+						continue;
+					for (unsigned int v = offset; v < mesh->_vertices.size(); v += size)
+						for (unsigned int i = 0; i < ATTRIBUTE_SIZE(a); i++) {
+							unsigned int bits;
+							memcpy(&bits, &mesh->_vertices[v + i], sizeof(bits));
+							result = result * 31 + bits;
+						}
+				}
+			}
+			return result;
+		}
+
+		/** Check whether the second geometry equals the first geometry transformed by a rotation and translation (which is stored in transform) */
+		bool isInstance(FbxMeshInfo * const &info1, const std::vector<Mesh *> &meshes1, FbxMeshInfo * const &info2, const std::vector<Mesh *> &meshes2, FbxAMatrix &transform) {
+			const std::vector<std::vector<MeshPart *> > &parts1 = meshParts[info1], &parts2 = meshParts[info2];
+			if (parts1.size() != parts2.size() || meshes1.size() != meshes2.size())
+				return false;
+			for (unsigned int i = 0; i < parts1.size(); i++) {
+				if (parts1[i].size() != parts2[i].size())
+					return false;
+				for (unsigned int j = 0; j < parts1[i].size(); j++)
+					if ((parts1[i][j] == 0) != (parts2[i][j] == 0) || (parts1[i][j] != 0 && (parts1[i][j]->indices != parts2[i][j]->indices || 
+							parts1[i][j]->constantColor != parts2[i][j]->constantColor || parts1[i][j]->binormalSign != parts2[i][j]->binormalSign)))
+						return false;
+			}
+			std::vector<FbxVector4> positions1, positions2;
+			for (unsigned int m = 0; m < meshes1.size(); m++) {
+				const Mesh * const &mesh1 = meshes1[m], * const &mesh2 = meshes2[m];
+				if (!(mesh1->_attributes == mesh2->_attributes) || mesh1->_vertices.size() != mesh2->_vertices.size() || mesh1->_parts.size() != mesh2->_parts.size())
+					return false;
+				const int offset = mesh1->_attributes.offset(ATTRIBUTE_POSITION);
+				if (offset >= 0)
+					for (unsigned int v = offset; v < mesh1->_vertices.size(); v += mesh1->_vertexSize) {
+						positions1.push_back(FbxVector4(mesh1->_vertices[v], mesh1->_vertices[v+1], mesh1->_vertices[v+2]));
+						positions2.push_back(FbxVector4(mesh2->_vertices[v], mesh2->_vertices[v+1], mesh2->_vertices[v+2]));
+					}
+			}
+
+			// Estimate the rotation from a frame spanned by three vertices as far apart as possible
+			double rotation[3][3] = {{1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}};
+			FbxVector4 translation;
+			if (!positions1.empty() && positions1 != positions2) {
+				unsigned int b = 0, c = 0;
+				double db = 0., dc = 0.;
+				for (unsigned int v = 1; v < positions1.size(); v++) {
+					const double d = (positions1[v] - positions1[0]).SquareLength();
+					if (d > db) {
+						db = d;
+						b = v;
+					}
+				}
+				for (unsigned int v = 1; v < positions1.size(); v++) {
+					const double d = (positions1[b] - positions1[0]).CrossProduct(positions1[v] - positions1[0]).SquareLength();
+					if (d > dc) {
+						dc = d;
+						c = v;
+					}
+				}
+				FbxVector4 frame1[3], frame2[3];
+				if (dc > 0. && getFrame(positions1[0], positions1[b], positions1[c], frame1) && getFrame(positions2[0], positions2[b], positions2[c], frame2)) {
+					for (int i = 0; i < 3; i++)
+						for (int j = 0; j < 3; j++)
+							rotation[i][j] = frame2[0][i] * frame1[0][j] + frame2[1][i] * frame1[1][j] + frame2[2][i] * frame1[2][j];
+				}
+				for (int i = 0; i < 3; i++)
+					translation[i] = positions2[0][i] - (rotation[i][0] * positions1[0][0] + rotation[i][1] * positions1[0][1] + rotation[i][2] * positions1[0][2]);
+				const double epsilon = 1e-5 * sqrt(db) + 1e-6;
+				for (unsigned int v = 0; v < positions1.size(); v++)
+					if (!isRotated(positions1[v].mData, positions2[v].mData, rotation, translation.mData, epsilon))
+						return false;
+			}
+
+			const double zero[3] = {0., 0., 0.};
+			for (unsigned int m = 0; m < meshes1.size(); m++) {
+				const Mesh * const &mesh1 = meshes1[m], * const &mesh2 = meshes2[m];
+				const unsigned int size = mesh1->_vertexSize;
+				for (unsigned int a = 0; a < ATTRIBUTE_COUNT; a++) {
+					const int offset = mesh1->_attributes.offset(a);
+					if (offset < 0 || a == ATTRIBUTE_POSITION)
+						continue;
+					const bool direction = a == ATTRIBUTE_NORMAL || a == ATTRIBUTE_TANGENT || a == ATTRIBUTE_BINORMAL;
+					for (unsigned int v = offset; v < mesh1->_vertices.size(); v += size) {
+						if (a == ATTRIBUTE_QTANGENT) {
+							// The frames must be rotated and have the same handedness
+							double n1[3], t1[3], b1[3], n2[3], t2[3], b2[3];
+							fromQTangent(&mesh1->_vertices[v], n1, t1, b1);
+							fromQTangent(&mesh2->_vertices[v], n2, t2, b2);
+							if ((mesh1->_vertices[v+3] < 0.f) != (mesh2->_vertices[v+3] < 0.f) || 
+									!isRotated(n1, n2, rotation, zero, 1e-4) || !isRotated(t1, t2, rotation, zero, 1e-4))
+								return false;
+						}
+						else if (direction) {
+							const double d1[3] = {mesh1->_vertices[v], mesh1->_vertices[v+1], mesh1->_vertices[v+2]};
+							const double d2[3] = {mesh2->_vertices[v], mesh2->_vertices[v+1], mesh2->_vertices[v+2]};
+							if (!isRotated(d1, d2, rotation, zero, 1e-4))
+								return false;
+						}
+						else if (memcmp(&mesh1->_vertices[v], &mesh2->_vertices[v], ATTRIBUTE_SIZE(a) * sizeof(float)) != 0)
+							return false;
+					}
+				}
+			}
+
+			transform.SetIdentity();
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++)
+					transform.mData[j][i] = rotation[i][j];
+				transform.mData[3][i] = translation[i];
+			}
+			return true;
+		}
+
+		inline static bool getFrame(const FbxVector4 &a, const FbxVector4 &b, const FbxVector4 &c, FbxVector4 (&frame)[3]) {
+			frame[0] = b - a;
+			frame[1] = c - a;
+			if (frame[0].Length() <= 0.)
+				return false;
+			frame[0].Normalize();
+			frame[1] -= frame[0] * frame[0].DotProduct(frame[1]);
+			if (frame[1].Length() <= 0.)
+				return false;
+			frame[1].Normalize();
+			frame[2] = frame[0].CrossProduct(frame[1]);
+			return true;
+		}
+
+		inline static bool isRotated(const double * const &v1, const double * const &v2, const double (&rotation)[3][3], const double * const &translation, const double &epsilon) {
+			for (int i = 0; i < 3; i++) {
+				const double d = rotation[i][0] * v1[0] + rotation[i][1] * v1[1] + rotation[i][2] * v1[2] + translation[i] - v2[i];
+				if (d > epsilon || d < -epsilon)
+					return false;
+			}
+			return true;
+		}
+
+		/** Collect the mesh of each node (leaves first) along with the position of the node within the hierarchy (depth first). */
+		void collectMeshes(std::vector<std::pair<FbxMeshInfo *, FbxNode *> > &meshes, std::vector<double> &localities, std::set<FbxMeshInfo *> &collected,
+			unsigned int &nodeIndex, FbxNode * node = 0) {
 			if (node == 0)
 				node = scene->GetRootNode();
+			const unsigned int index = nodeIndex++;
 			const int childCount = node->GetChildCount();
 			for (int i = 0; i < childCount; i++)
-				addMesh(model, node->GetChild(i));
+				collectMeshes(meshes, localities, collected, nodeIndex, node->GetChild(i));
 
 			FbxGeometry *geometry = node->GetGeometry();
 			if (geometry) {
-				if (_fbxMeshMap.find(geometry) != _fbxMeshMap.end())
-					addMesh(model, _fbxMeshMap[geometry], node);
-				else
+				if (_fbxMeshMap.find(geometry) == _fbxMeshMap.end())
 					log->debug("Geometry(%X) of %s not found in _fbxMeshMap[size=%d]", (unsigned long)(geometry), node->GetName(), _fbxMeshMap.size());
+				else {
+					FbxMeshInfo * const &meshInfo = _fbxMeshMap[geometry];
+					if (!collected.insert(meshInfo).second)
+						return;
+					meshes.push_back(std::make_pair(meshInfo, node));
+					localities.push_back((double)index);
+				}
 			}
-			
 		}
 
-		void addMesh(Model * const &model, FbxMeshInfo * const &meshInfo, FbxNode * const &node) {
-			if (meshParts.find(meshInfo) != meshParts.end())
+		/** Set the locality of each mesh to the position of the center of its world bounds along a Morton (Z-order) curve through the scene. */
+		void calculateSpatialLocality(const std::vector<Mesh *> &meshes, const std::vector<FbxNode *> &nodes, std::vector<MeshPackItem> &items) {
+			std::vector<FbxVector4> centers;
+			FbxVector4 min, max;
+			for (unsigned int i = 0; i < meshes.size(); i++) {
+				Mesh * const &mesh = meshes[i];
+				FbxVector4 bmin, bmax;
+				if (mesh->_attributes.hasPosition()) {
+					const unsigned int count = mesh->vertexCount();
+					for (unsigned int v = 0; v < count; v++) {
+						const float * const &position = &mesh->_vertices[v * mesh->_vertexSize];
+						for (int j = 0; j < 3; j++) {
+							if (v == 0 || position[j] < bmin[j])
+								bmin[j] = position[j];
+							if (v == 0 || position[j] > bmax[j])
+								bmax[j] = position[j];
+						}
+					}
+				}
+				const FbxVector4 center = (bmin + bmax) * 0.5;
+				const FbxAMatrix transform = nodes[i]->EvaluateGlobalTransform() * GetGeometry(nodes[i]);
+				centers.push_back(transform.MultT(center));
+				for (int j = 0; j < 3; j++) {
+					if (i == 0 || centers[i][j] < min[j])
+						min[j] = centers[i][j];
+					if (i == 0 || centers[i][j] > max[j])
+						max[j] = centers[i][j];
+				}
+			}
+			for (unsigned int i = 0; i < centers.size(); i++) {
+				unsigned int code = 0;
+				for (int j = 0; j < 3; j++) {
+					const double range = max[j] - min[j];
+					const unsigned int v = range > 0. ? (unsigned int)((centers[i][j] - min[j]) / range * 1023.) : 0;
+					for (int b = 0; b < 10; b++)
+						code |= ((v >> b) & 1) << (3 * b + j);
+				}
+				items[i].locality = (double)code / (double)(1 << 30);
+			}
+		}
+
+		/** Log the vertex and index buffer utilization of all meshes. */
+		void reportMeshUtilization(Model * const &model, const unsigned int &sourceCount, const unsigned int &lowerBound) {
+			double vertexUtilization = 0., indexUtilization = 0.;
+			for (std::vector<Mesh *>::iterator itr = model->meshes.begin(); itr != model->meshes.end(); ++itr) {
+				const unsigned int vertexCount = (*itr)->vertexCount();
+				const unsigned int indexCount = (*itr)->indexCount();
+				const double vu = 100. * (double)vertexCount / (double)std::max(settings->maxVertexCount, 1);
+				const double iu = 100. * (double)indexCount / (double)std::max(settings->maxIndexCount, 1);
+				log->verbose(log::iSourceConvertMeshUtilization, (*itr)->_name.c_str(), vertexCount, settings->maxVertexCount, vu, indexCount, settings->maxIndexCount, iu);
+				vertexUtilization += vu;
+				indexUtilization += iu;
+			}
+			const unsigned int count = (unsigned int)model->meshes.size();
+			if (count > 0)
+				log->verbose(log::iSourceConvertMeshPacking, sourceCount, count, lowerBound > 0 ? lowerBound : count, vertexUtilization / count, indexUtilization / count);
+		}
+
+		/** Split the polygons of the mesh into spatially coherent chunks (by recursively bisecting the polygon centers along the longest axis) 
+		 * so that each chunk fits within the maximum index and vertex count. Returns the number of chunks. */
+		unsigned int splitMesh(FbxMeshInfo * const &meshInfo, std::vector<unsigned int> &polyChunkMap) {
+			const unsigned int polyCount = meshInfo->getPolyCount();
+			const unsigned int limit = (unsigned int)std::min(settings->maxIndexCount, settings->maxVertexCount);
+			polyChunkMap.assign(polyCount, 0);
+			if ((unsigned int)meshInfo->_mesh->GetPolygonVertexCount() <= limit || limit < 3)
+				return 1;
+
+			std::vector<FbxVector4> centers(polyCount);
+			std::vector<unsigned int> polys(polyCount);
+			for (unsigned int poly = 0; poly < polyCount; poly++) {
+				const int ps = meshInfo->_mesh->GetPolygonSize(poly);
+				for (int i = 0; i < ps; i++)
+					centers[poly] += meshInfo->_mesh->GetControlPointAt(meshInfo->_mesh->GetPolygonVertex(poly, i));
+				centers[poly] /= (double)std::max(ps, 1);
+				polys[poly] = poly;
+			}
+
+			unsigned int chunkCount = 0;
+			std::vector<std::pair<unsigned int, unsigned int> > ranges;
+			ranges.push_back(std::make_pair(0U, polyCount));
+			while (!ranges.empty()) {
+				const unsigned int first = ranges.back().first, last = ranges.back().second;
+				ranges.pop_back();
+				unsigned int indexCount = 0;
+				FbxVector4 min, max;
+				for (unsigned int i = first; i < last; i++) {
+					indexCount += meshInfo->_mesh->GetPolygonSize(polys[i]);
+					for (int j = 0; j < 3; j++) {
+						if (i == first || centers[polys[i]][j] < min[j])
+							min[j] = centers[polys[i]][j];
+						if (i == first || centers[polys[i]][j] > max[j])
+							max[j] = centers[polys[i]][j];
+					}
+				}
+				if (indexCount <= limit || last - first < 2) {
+					for (unsigned int i = first; i < last; i++)
+						polyChunkMap[polys[i]] = chunkCount;
+					chunkCount++;
+					continue;
+				}
+				const FbxVector4 size = max - min;
+				const int axis = size[0] >= size[1] && size[0] >= size[2] ? 0 : (size[1] >= size[2] ? 1 : 2);
+				const unsigned int mid = first + (last - first) / 2;
+				std::nth_element(polys.begin() + first, polys.begin() + mid, polys.begin() + last, CenterComparator(centers, axis));
+				ranges.push_back(std::make_pair(mid, last));
+				ranges.push_back(std::make_pair(first, mid));
+			}
+			return chunkCount;
+		}
+
+		struct CenterComparator {
+			const std::vector<FbxVector4> &centers;
+			const int axis;
+			CenterComparator(const std::vector<FbxVector4> &centers, const int &axis) : centers(centers), axis(axis) {}
+			inline bool operator()(const unsigned int &lhs, const unsigned int &rhs) const {
+				return centers[lhs][axis] < centers[rhs][axis];
+			}
+		};
+
+		/** Set the (transformed) uv bounds of the part from the bounds calculated for the material part of the mesh */
+		void setUVBounds(MeshPart * const &part, FbxMeshInfo * const &meshInfo, const int &materialIndex) {
+			if (meshInfo->_partUVBounds == 0)
 				return;
+			part->uvBounds.resize(4 * meshInfo->uvCount);
+			for (unsigned int k = 0; k < meshInfo->uvCount; k++) {
+				const float * const bounds = &meshInfo->_partUVBounds[4 * (materialIndex * meshInfo->uvCount + k)];
+				if (bounds[0] > bounds[2]) {
+					part->uvBounds.clear();
+					return;
+				}
+				float x1 = bounds[0], y1 = bounds[1], x2 = bounds[2], y2 = bounds[3];
+				uvTransforms[k].transform(x1, y1);
+				uvTransforms[k].transform(x2, y2);
+				part->uvBounds[4*k] = std::min(x1, x2);
+				part->uvBounds[4*k+1] = std::min(y1, y2);
+				part->uvBounds[4*k+2] = std::max(x1, x2);
+				part->uvBounds[4*k+3] = std::max(y1, y2);
+			}
+		}
 
-			Mesh *mesh = findReusableMesh(model, meshInfo->attributes, meshInfo->getPolyCount() * 3);
-			if (mesh == 0) {
-				mesh = new Mesh();
-				model->meshes.push_back(mesh);
-                mesh->_name = meshInfo->_meshName;
-				mesh->_attributes = meshInfo->attributes;
-				mesh->_vertexSize = mesh->_attributes.size();
+		/** Create the meshes containing only the specified meshInfo, the mesh is split into multiple meshes if it exceeds the maximum 
+		 * index or vertex count. Returns false if the mesh is invalid. */
+		bool createMesh(FbxMeshInfo * const &meshInfo, FbxNode * const &node, std::vector<Mesh *> &result) {
+			if (meshParts.find(meshInfo) != meshParts.end())
+				return false;
+
+			std::vector<unsigned int> polyChunkMap;
+			const unsigned int chunkCount = splitMesh(meshInfo, polyChunkMap);
+			if (chunkCount > 1)
+				log->verbose(log::iSourceConvertFbxSplitMesh, meshInfo->id.c_str(), meshInfo->_mesh->GetPolygonVertexCount(), 
+					std::min(settings->maxIndexCount, settings->maxVertexCount), chunkCount);
+
+			std::vector<Mesh *> chunks(chunkCount);
+			for (unsigned int c = 0; c < chunkCount; c++) {
+				chunks[c] = new Mesh();
+				chunks[c]->_name = meshInfo->_meshName;
+				chunks[c]->_attributes = meshInfo->attributes;
+				chunks[c]->_vertexSize = chunks[c]->_attributes.size();
 			}
 
+			// [materialIndex][boneIndex * chunkCount + chunkIndex]
 			std::vector<std::vector<MeshPart *> > &parts = meshParts[meshInfo];
 			parts.resize(meshInfo->_meshPartCount);
 			for (int i = 0; i < meshInfo->_meshPartCount; i++) {
 				const int n = meshInfo->_partBones[i].size();
 				const int m = n == 0 ? 1 : n;
-				parts[i].resize(m);
+				parts[i].resize(m * chunkCount);
 				for (int j = 0; j < m; j++) {
-					MeshPart *part = new MeshPart();
-					part->primitiveType = PRIMITIVETYPE_TRIANGLES;
-					parts[i][j] = part;
-					mesh->_parts.push_back(part);
-					if (j < n)
-						for (int k = 0; k < meshInfo->_partBones[i][j].size(); k++)
-							part->sourceBones.push_back(meshInfo->getBone(meshInfo->_partBones[i][j][k]));
+					for (unsigned int c = 0; c < chunkCount; c++) {
+						MeshPart *part = new MeshPart();
+						part->primitiveType = PRIMITIVETYPE_TRIANGLES;
+						setUVBounds(part, meshInfo, i);
+						parts[i][j * chunkCount + c] = part;
+						chunks[c]->_parts.push_back(part);
+						if (j < n)
+							for (int k = 0; k < meshInfo->_partBones[i][j].size(); k++)
+								part->sourceBones.push_back(meshInfo->getBone(meshInfo->_partBones[i][j][k]));
+					}
 				}
 			}
 
-			float *vertex = new float[mesh->_vertexSize];
+			float *vertex = new float[meshInfo->attributes.size()];
 			unsigned int pidx = 0;
 			for (unsigned int poly = 0; poly < meshInfo->getPolyCount(); poly++) {
 				unsigned int ps = meshInfo->_mesh->GetPolygonSize(poly);
 				unsigned int pi = meshInfo->_polyPartMap[poly];
-				unsigned int bi = meshInfo->_polyPartBonesMap[poly];
+				unsigned int bi = meshInfo->_polyPartBonesMap[poly] * chunkCount + polyChunkMap[poly];
 				if (pi >= parts.size() || bi >= parts[pi].size()) {
 					log->warning(log::wSourceConvertFbxInvalidMesh, node->GetName());
 					delete[] vertex;
-					return;
+					for (std::vector<Mesh *>::iterator itr = chunks.begin(); itr != chunks.end(); ++itr)
+						delete (*itr);
+					meshParts.erase(meshInfo);
+					return false;
 				}
 				MeshPart * const &part = parts[pi][bi];
+				Mesh * const &mesh = chunks[polyChunkMap[poly]];
 				//Material * const &material = _materialsMap[node->GetMaterial(meshInfo->_polyPartMap[poly])];
 
 				for (unsigned int i = 0; i < ps; i++) {
@@ -378,30 +1292,188 @@ namespace readers {
 
 			int idx = 0;
 			for (int i = parts.size() - 1; i >= 0; --i) {
+				bool empty = true;
 				for (int j = parts[i].size() - 1; j >= 0; --j) {
 					MeshPart *part = parts[i][j];
 					if (!part->indices.size()) {
 						parts[i][j] = 0;
+						Mesh * const &mesh = chunks[j % chunkCount];
 						mesh->_parts.erase(std::remove(mesh->_parts.begin(), mesh->_parts.end(), part), mesh->_parts.end());
-						log->warning(log::wSourceConvertFbxEmptyMeshpart, node->GetName(), node->GetMaterial(i)->GetName());
 						delete part;
 					}
 					else {
+						empty = false;
 						std::stringstream ss;
 						ss << meshInfo->id.c_str() << "_part" << (++idx);
 						part->id = ss.str();
 					}
 				}
+				if (empty)
+					log->warning(log::wSourceConvertFbxEmptyMeshpart, node->GetName(), node->GetMaterial(i)->GetName());
 			}
 
 			delete[] vertex;
+			result.insert(result.end(), chunks.begin(), chunks.end());
+			return true;
+		}
+
+		/** Decide the size of the indices of each mesh, based on the settings and the amount of vertices the mesh contains */
+		void setIndexWidths(Model * const &model) {
+			for (std::vector<Mesh *>::iterator itr = model->meshes.begin(); itr != model->meshes.end(); ++itr) {
+				const unsigned int vertexCount = (*itr)->vertexCount();
+				unsigned int bits = (unsigned int)settings->indexWidth;
+				if (bits == INDEXWIDTH_AUTO)
+					bits = vertexCount > INDEXWIDTH_16_MAX ? INDEXWIDTH_32 : INDEXWIDTH_16;
+				else if (bits == INDEXWIDTH_16 && vertexCount > INDEXWIDTH_16_MAX)
+					log->warning(log::wSourceConvertExceedsIndexWidth, (*itr)->_name.c_str(), vertexCount, bits);
+				(*itr)->setIndexWidth(bits);
+				log->verbose(log::iSourceConvertIndexWidth, (*itr)->_name.c_str(), vertexCount, bits);
+			}
+		}
+
+		/** Encode the vertices of all meshes according to the vertex format settings */
+		void encodeVertices(Model * const &model) {
+			unsigned int count = 0, floatBytes = 0, encodedBytes = 0;
+			float errors[ATTRIBUTE_COUNT], maxErrors[ATTRIBUTE_COUNT];
+			memset(maxErrors, 0, sizeof(maxErrors));
+			Attributes encoded;
+			for (std::vector<Mesh *>::iterator itr = model->meshes.begin(); itr != model->meshes.end(); ++itr) {
+				Mesh * const &mesh = *itr;
+				Attributes &attributes = mesh->_attributes;
+				if (settings->quantizePositions && attributes.hasPosition())
+					attributes.setComponentType(ATTRIBUTE_POSITION, ATTRIBUTE_TYPE_UNORM16);
+				if (settings->octahedralBits > 0) {
+					const unsigned short type = settings->octahedralBits == 8 ? ATTRIBUTE_TYPE_OCT8 : ATTRIBUTE_TYPE_OCT16;
+					attributes.setComponentType(ATTRIBUTE_NORMAL, type);
+					attributes.setComponentType(ATTRIBUTE_TANGENT, type);
+					attributes.setComponentType(ATTRIBUTE_BINORMAL, type);
+				}
+				if (settings->blendWeightBits > 0 && attributes.hasBlendInfo()) {
+					attributes.setComponentType(ATTRIBUTE_BLENDINDEX, ATTRIBUTE_TYPE_UINT8);
+					attributes.setComponentType(ATTRIBUTE_BLENDWEIGHT, settings->blendWeightBits == 8 ? ATTRIBUTE_TYPE_UNORM8 : ATTRIBUTE_TYPE_UNORM16);
+				}
+				if (attributes.hasQTangent())
+					attributes.setComponentType(ATTRIBUTE_QTANGENT, ATTRIBUTE_TYPE_SNORM16);
+				if (settings->uvFormat != UVFORMAT_FLOAT)
+					for (unsigned int a = ATTRIBUTE_TEXCOORD0; a <= ATTRIBUTE_TEXCOORD7; a++)
+						attributes.setComponentType(a, settings->uvFormat == UVFORMAT_HALF ? ATTRIBUTE_TYPE_HALF : ATTRIBUTE_TYPE_UNORM16);
+				for (std::vector<std::pair<int, int> >::const_iterator it = settings->vertexFormat.begin(); it != settings->vertexFormat.end(); ++it)
+					attributes.setComponentType(it->first, (unsigned short)it->second);
+				bool normalizedUVs = false;
+				for (unsigned int a = ATTRIBUTE_TEXCOORD0; a <= ATTRIBUTE_TEXCOORD7; a++)
+					normalizedUVs = normalizedUVs || (attributes.has(a) && (attributes.types[a] & ATTRIBUTE_TYPE_NORMALIZED));
+				if (normalizedUVs) {
+					unsigned int maxVertexCount = std::max((unsigned int)settings->maxVertexCount, mesh->vertexCount());
+					for (std::vector<MeshPart *>::const_iterator itr = mesh->_parts.begin(); itr != mesh->_parts.end(); ++itr)
+						if ((*itr)->indexWidth == INDEXWIDTH_16)
+							maxVertexCount = std::min(maxVertexCount, (unsigned int)INDEXWIDTH_16_MAX);
+					if (!mesh->calculateUVTransforms(maxVertexCount)) {
+						log->warning(log::wSourceConvertEncodeUVVertices, mesh->_name.c_str(), maxVertexCount);
+						for (unsigned int a = ATTRIBUTE_TEXCOORD0; a <= ATTRIBUTE_TEXCOORD7; a++)
+							if (attributes.types[a] & ATTRIBUTE_TYPE_NORMALIZED)
+								attributes.setComponentType(a, ATTRIBUTE_TYPE_HALF);
+					}
+				}
+				if (!attributes.isEncoded())
+					continue;
+				mesh->encode(errors);
+				log->verbose(log::iSourceConvertEncodeMesh, mesh->_name.c_str(), (int)(mesh->_vertexSize * sizeof(float)), mesh->_vertexStride);
+				for (unsigned int a = 0; a < ATTRIBUTE_COUNT; a++) {
+					if (!attributes.has(a) || attributes.types[a] == ATTRIBUTE_TYPE_FLOAT)
+						continue;
+					log->verbose(log::iSourceConvertEncodeError, mesh->_name.c_str(), AttributeNames[a], errors[a], (attributes.types[a] & ATTRIBUTE_TYPE_OCTAHEDRAL) ? " degrees" : "");
+					maxErrors[a] = std::max(maxErrors[a], errors[a]);
+					encoded.add(a);
+					encoded.types[a] |= attributes.types[a] & ATTRIBUTE_TYPE_OCTAHEDRAL;
+				}
+				count++;
+				floatBytes += mesh->_vertices.size() * sizeof(float);
+				encodedBytes += mesh->_encodedVertices.size();
+			}
+			if (count == 0)
+				return;
+			log->info(log::iSourceConvertEncodeSummary, count, floatBytes, encodedBytes);
+			for (unsigned int a = 0; a < ATTRIBUTE_COUNT; a++)
+				if (encoded.has(a))
+					log->info(log::iSourceConvertEncodeSummaryError, AttributeNames[a], maxErrors[a], (encoded.types[a] & ATTRIBUTE_TYPE_OCTAHEDRAL) ? " degrees" : "");
 		}
 
-		Mesh *findReusableMesh(Model * const &model, const Attributes &attributes, const unsigned int &vertexCount) {
+		/** Compress the indices of the triangle parts, each part is decoded again to verify the result */
+		void encodeIndices(Model * const &model) {
+			if (!IndexCodec::test()) {
+				log->warning(log::wSourceConvertIndexCodecTest);
+				return;
+			}
+			unsigned int count = 0, rawBytes = 0, encodedBytes = 0;
+			std::vector<unsigned int> decoded;
+			for (std::vector<Mesh *>::iterator itr = model->meshes.begin(); itr != model->meshes.end(); ++itr) {
+				for (std::vector<MeshPart *>::iterator it = (*itr)->_parts.begin(); it != (*itr)->_parts.end(); ++it) {
+					MeshPart * const &part = *it;
+					if (part->primitiveType != PRIMITIVETYPE_TRIANGLES || part->indices.empty())
+						continue;
+					IndexCodec::encode(part->indices, part->encodedIndices);
+					if (!IndexCodec::decode(&part->encodedIndices[0], (unsigned int)part->encodedIndices.size(), decoded) || !IndexCodec::isEquivalent(part->indices, decoded)) {
+						log->warning(log::wSourceConvertEncodeIndices, part->id.c_str());
+						part->encodedIndices.clear();
+						continue;
+					}
+					count++;
+					rawBytes += (unsigned int)part->indices.size() * part->indexWidth / 8;
+					encodedBytes += (unsigned int)part->encodedIndices.size();
+				}
+			}
+			if (count > 0)
+				log->info(log::iSourceConvertEncodeIndices, count, rawBytes, encodedBytes);
+		}
+
+		/** Compress the (encoded) vertices of each mesh, keeping them uncompressed if that's smaller. Each mesh is decompressed 
+		 * again to verify the result, the throughput of the reference decoder is reported as benchmark. */
+		void compressVertices(Model * const &model) {
+			unsigned int count = 0, rawBytes = 0, compressedBytes = 0;
+			float errors[ATTRIBUTE_COUNT];
+			std::vector<unsigned char> decoded;
+			clock_t decodeTime = 0;
+			for (std::vector<Mesh *>::iterator itr = model->meshes.begin(); itr != model->meshes.end(); ++itr) {
+				Mesh * const &mesh = *itr;
+				if (mesh->vertexCount() == 0)
+					continue;
+				// Meshes that aren't encoded are compressed as their float vertices, but stay as they are if that doesn't pay off
+				const bool encoded = !mesh->_encodedVertices.empty();
+				if (!encoded)
+					mesh->encode(errors);
+				const unsigned int vertexCount = mesh->vertexCount();
+				VertexCodec::encode(&mesh->_encodedVertices[0], vertexCount, mesh->_vertexStride, mesh->_compressedVertices);
+				bool valid = mesh->_compressedVertices.size() < mesh->_encodedVertices.size();
+				if (valid) {
+					const clock_t start = clock();
+					valid = VertexCodec::decode(&mesh->_compressedVertices[0], (unsigned int)mesh->_compressedVertices.size(), vertexCount, mesh->_vertexStride, decoded);
+					decodeTime += clock() - start;
+					valid = valid && decoded == mesh->_encodedVertices;
+					if (!valid)
+						log->warning(log::wSourceConvertCompressVertices, mesh->_name.c_str());
+				}
+				if (!valid) {
+					mesh->_compressedVertices.clear();
+					if (!encoded) {
+						mesh->_encodedVertices.clear();
+						mesh->_vertexStride = 0;
+					}
+					continue;
+				}
+				count++;
+				rawBytes += (unsigned int)mesh->_encodedVertices.size();
+				compressedBytes += (unsigned int)mesh->_compressedVertices.size();
+			}
+			if (count > 0)
+				log->info(log::iSourceConvertCompressVertices, count, rawBytes, compressedBytes, (double)rawBytes / (double)compressedBytes,
+					decodeTime > 0 ? (double)rawBytes / 1e6 / ((double)decodeTime / CLOCKS_PER_SEC) : 0.);
+		}
+
+		Mesh *findReusableMesh(Model * const &model, const Attributes &attributes, const unsigned int &vertexCount, const unsigned int &indexCount) {
 			for (std::vector<Mesh *>::iterator itr = model->meshes.begin(); itr != model->meshes.end(); ++itr)
 				if ((*itr)->_attributes == attributes && 
-					((*itr)->_vertices.size() / (*itr)->_vertexSize) + vertexCount <= settings->maxVertexCount &&
-					(*itr)->indexCount() + vertexCount <= settings->maxIndexCount)
+					(*itr)->vertexCount() + vertexCount <= settings->maxVertexCount &&
+					(*itr)->indexCount() + indexCount <= settings->maxIndexCount)
 					return (*itr);
 			return 0;
 		}
@@ -427,6 +1499,10 @@ namespace readers {
 					for (unsigned int k = 0; k < meshInfo->uvCount; k++) {
 						if (meshInfo->uvMapping[k] == texture->UVSet.Get().Buffer()) {
 							const int idx = 4 * (i * meshInfo->uvCount + k);
+							if (meshInfo->_partUVBounds[idx] > meshInfo->_partUVBounds[idx+2]) {
+								info.nodeCount++;
+								break;
+							}
 							if (*(int*)&info.bounds[0] == -1 || meshInfo->_partUVBounds[idx] < info.bounds[0])
 								info.bounds[0] = meshInfo->_partUVBounds[idx];
 							if (*(int*)&info.bounds[1] == -1 || meshInfo->_partUVBounds[idx+1] < info.bounds[1])
@@ -492,13 +1568,11 @@ namespace readers {
 					FbxMesh *mesh = (FbxMesh*)geometry;
 					int indexCount = (mesh->GetPolygonCount() * 3);
 					log->verbose(log::iSourceConvertFbxMeshInfo, getGeometryName(mesh), mesh->GetPolygonCount(), indexCount, mesh->GetControlPointsCount());
-					if (indexCount > settings->maxIndexCount)
-						log->warning(log::wSourceConvertFbxExceedsIndices, indexCount, settings->maxIndexCount);
 					if (mesh->GetElementMaterialCount() <= 0) {
 						log->error(log::wSourceConvertFbxNoMaterial, getGeometryName(mesh));
 						continue;
 					}
-					FbxMeshInfo * const info = new FbxMeshInfo(log, getGeometryName(mesh), mesh, settings->packColors, settings->maxVertexBonesCount, settings->forceMaxVertexBoneCount, settings->maxNodePartBonesCount);
+					FbxMeshInfo * const info = new FbxMeshInfo(log, getGeometryName(mesh), mesh, settings->packColors, settings->maxVertexBonesCount, settings->forceMaxVertexBoneCount, settings->maxNodePartBonesCount, settings->qtangents);
 					_meshInfos.push_back(info);
 					_fbxMeshMap[mesh] = info;
 					if (info->bonesOverflow)
@@ -628,18 +1702,199 @@ namespace readers {
 			return result;
 		}
 
-		/** Add the animations if any */
-		void addAnimations(Model * const &model, const FbxScene * const &source) {
+		/** The samples of the local transform of a node during an animation stack */
+		struct AnimationSamples {
+			// The index of the animation stack within the scene
+			unsigned int stack;
+			// The index of the node within the scene (depth first), used to find the node in a copy of the scene
+			unsigned int node;
+			AnimInfo info;
+			float animStart;
+			Animation *animation;
+			NodeAnimation *nodeAnimation;
+			std::vector<Keyframe *> frames;
+			// The key times (FbxTime) of the curves of the node if the keyframes at those times reproduce the curves, empty if sampling is required
+			std::vector<FbxLongLong> keyTimes;
+			// The curves of the translation, rotation and scale (x, y and z) and whether their derivatives are the tangents of the keyframes
+			FbxAnimCurve *curves[3][3];
+			bool curveTangents;
+			// The clips (indices) the samples are split into, instead of adding them to the animation
+			std::vector<unsigned int> clips;
+		};
+
+		/** The curves that animate a node during an animation stack and their key times, including the time just before the next key of 
+		 * a constant segment */
+		struct AnimationKeys {
+			std::set<FbxLongLong> times;
+			// The curves of the translation, rotation and scale (x, y and z), null if the component isn't animated
+			FbxAnimCurve *curves[3][3];
+			// Whether any of the curves has a cubic segment or a constant segment that changes the value
+			bool cubic;
+			bool constant;
+			// Whether all segments of the curves are linear, constant or cubic Hermite curves (as checked by addCurveKeys)
+			bool exact;
+
+			AnimationKeys() : cubic(false), constant(false), exact(true) {
+				memset(curves, 0, sizeof(curves));
+			}
+		};
+
+		/** A clip of an animation take, as defined by the clips file */
+		struct AnimationClip {
+			std::string id;
+			// The index of the animation stack (take)
+			int stack;
+			FbxTime start;
+			FbxTime stop;
+			bool loop;
+			Animation *animation;
+		};
+		std::vector<AnimationClip> clips;
+
+		/** Read the clips file (if any), returns false if it can't be read or contains an invalid line. Empty lines and lines starting with 
+		 * # are skipped. A line "take <name>" selects the take of the clips that follow (by default the first take), any other line defines 
+		 * a clip of that take: "<name> <start frame> <end frame> [loop]", using the frame rate of the scene. */
+		bool loadClips(const FbxScene * const &source) {
+			clips.clear();
+			if (settings->clipsFile.empty())
+				return true;
+			std::ifstream file(settings->clipsFile.c_str());
+			if (!file.is_open()) {
+				log->error(log::eSourceConvertClips, settings->clipsFile.c_str());
+				return false;
+			}
+			const double framerate = FbxTime::GetFrameRate(source->GetGlobalSettings().GetTimeMode());
+			int stack = 0;
+			std::string line;
+			for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+				std::istringstream tokens(line);
+				std::string name, flag;
+				if (!(tokens >> name) || name[0] == '#')
+					continue;
+				if (name == "take") {
+					std::string take;
+					std::getline(tokens >> std::ws, take);
+					take = take.substr(0, take.find_last_not_of(" \t\r") + 1);
+					for (stack = source->GetSrcObjectCount<FbxAnimStack>() - 1; stack >= 0; stack--)
+						if (take == source->GetSrcObject<FbxAnimStack>(stack)->GetName())
+							break;
+					if (stack < 0) {
+						log->error(log::eSourceConvertClipsTake, settings->clipsFile.c_str(), lineNumber, take.c_str());
+						return false;
+					}
+					continue;
+				}
+				double start, stop;
+				if (!(tokens >> start >> stop) || stop < start || !(framerate > 0.) || ((tokens >> flag) && flag != "loop")) {
+					log->error(log::eSourceConvertClipsLine, settings->clipsFile.c_str(), lineNumber);
+					return false;
+				}
+				AnimationClip clip;
+				clip.id = name;
+				clip.stack = stack;
+				clip.start.SetSecondDouble(start / framerate);
+				clip.stop.SetSecondDouble(stop / framerate);
+				clip.loop = flag == "loop";
+				clip.animation = 0;
+				clips.push_back(clip);
+			}
+			return true;
+		}
+
+		/** Add the animations if any, returns false if the clips couldn't be read. The animation stacks are sampled in one pass, the 
+		 * animation stacks with clips are split into an animation per clip afterwards, so samples shared by clips are only computed once. */
+		bool addAnimations(Model * const &model, const FbxScene * const &source) {
+			if (!loadClips(source))
+				return false;
+			std::vector<AnimationSamples> samples;
+			std::map<const FbxNode *, unsigned int> nodeIndices;
+			std::vector<FbxNode *> nodes;
+			getNodes(source->GetRootNode(), nodes);
+			for (unsigned int i = 0; i < nodes.size(); i++)
+				nodeIndices[nodes[i]] = i;
 			const unsigned int animCount = source->GetSrcObjectCount<FbxAnimStack>();
 			for (unsigned int i = 0; i < animCount; i++)
-				addAnimation(model, source->GetSrcObject<FbxAnimStack>(i));
+				addAnimation(model, source->GetSrcObject<FbxAnimStack>(i), i, nodeIndices, samples);
+
+			sampleAnimations(samples, nodes.size(), animCount);
+
+			// Only add keyframes really needed, in the same order as the samples were collected so the result doesn't depend on the threads
+			std::map<const Animation *, std::pair<unsigned int, unsigned int> > keyCounts;
+			unsigned int keyed = 0;
+			for (std::vector<AnimationSamples>::iterator itr = samples.begin(); itr != samples.end(); ++itr) {
+				// Slow channels only use every so many samples, unless the keyframes are at the key times
+				unsigned int strides[3] = { 1, 1, 1 };
+				if (!(*itr).keyTimes.empty())
+					keyed++;
+				else
+					getSampleStrides((*itr).info, strides);
+				if ((*itr).clips.empty()) {
+					addNodeAnimation((*itr).animation, (*itr).nodeAnimation, (*itr).frames, strides, keyCounts[(*itr).animation]);
+					continue;
+				}
+				for (std::vector<unsigned int>::const_iterator clip = (*itr).clips.begin(); clip != (*itr).clips.end(); ++clip) {
+					std::vector<Keyframe *> frames;
+					getClipKeyframes(*itr, clips[*clip], frames);
+					Animation * const &animation = clips[*clip].animation;
+					addNodeAnimation(animation, new NodeAnimation(*(*itr).nodeAnimation), frames, strides, keyCounts[animation]);
+				}
+				for (std::vector<Keyframe *>::iterator kf = (*itr).frames.begin(); kf != (*itr).frames.end(); ++kf)
+					delete *kf;
+				delete (*itr).nodeAnimation;
+			}
+			if (settings->animTolerance > 0.f)
+				for (std::vector<Animation *>::const_iterator itr = model->animations.begin(); itr != model->animations.end(); ++itr)
+					log->verbose(log::iSourceConvertReduceKeyframes, (*itr)->id.c_str(), keyCounts[*itr].first, keyCounts[*itr].second);
+			if (useKeyTimes() && !samples.empty())
+				log->verbose(log::iSourceConvertKeyedAnimations, keyed, (int)samples.size());
+			// The take of these clips doesn't exist (the file has no animations) or doesn't animate any node
+			for (std::vector<AnimationClip>::const_iterator itr = clips.begin(); itr != clips.end(); ++itr)
+				if (!(*itr).animation)
+					log->warning(log::wSourceConvertClipsEmpty, (*itr).id.c_str());
+			return true;
 		}
 
-		/** Add the specified animation to the model */
-		void addAnimation(Model *const &model, FbxAnimStack * const &animStack) {
-			static std::vector<Keyframe *> frames;
+		/** Add the keyframes really needed to the node animation and add it to the animation if any of its channels is animated. 
+		 * Counts the sampled and added keys (per channel). */
+		void addNodeAnimation(Animation * const &animation, NodeAnimation * const &nodeAnim, std::vector<Keyframe *> &frames, 
+			const unsigned int (&strides)[3], std::pair<unsigned int, unsigned int> &keyCount) {
+			const unsigned int frameCount = (unsigned int)frames.size();
+			addKeyframes(nodeAnim, frames, strides);
+			keyCount.first += frameCount * ((nodeAnim->translate ? 1 : 0) + (nodeAnim->rotate ? 1 : 0) + (nodeAnim->scale ? 1 : 0));
+			for (std::vector<Keyframe *>::const_iterator kf = nodeAnim->keyframes.begin(); kf != nodeAnim->keyframes.end(); ++kf)
+				keyCount.second += ((*kf)->hasTranslation ? 1 : 0) + ((*kf)->hasRotation ? 1 : 0) + ((*kf)->hasScale ? 1 : 0);
+			if (nodeAnim->rotate || nodeAnim->scale || nodeAnim->translate)
+				animation->nodeAnimations.push_back(nodeAnim);
+			else
+				delete nodeAnim;
+		}
+
+		/** The time (in milliseconds, relative to the start of the animation stack) of the sample at the specified time */
+		inline static float getSampleTime(const AnimationSamples &sample, const FbxTime &time) {
+			return (float)(time.GetSecondDouble() * 1000.0 - sample.animStart);
+		}
+
+		/** Copy the sampled keyframes within the clip, with their time relative to the start of the clip */
+		void getClipKeyframes(const AnimationSamples &sample, const AnimationClip &clip, std::vector<Keyframe *> &frames) {
+			const float start = getSampleTime(sample, clip.start), stop = getSampleTime(sample, clip.stop);
+			// The samples at the start and stop of the clip are evaluated at those exact times, allow for rounding of the other samples
+			const float epsilon = 0.001f;
+			for (std::vector<Keyframe *>::const_iterator itr = sample.frames.begin(); itr != sample.frames.end(); ++itr) {
+				if ((*itr)->time < start - epsilon || (*itr)->time > stop + epsilon)
+					continue;
+				Keyframe *kf = new Keyframe(**itr);
+				kf->time = std::max(0.f, std::min(stop - start, kf->time - start));
+				frames.push_back(kf);
+			}
+		}
+
+		/** Add the specified animation to the model and collect the node animations which need to be sampled */
+		void addAnimation(Model *const &model, FbxAnimStack * const &animStack, const unsigned int &stackIndex, 
+			const std::map<const FbxNode *, unsigned int> &nodeIndices, std::vector<AnimationSamples> &samples) {
 			static std::map<FbxNode *, AnimInfo> affectedNodes;
+			static std::map<FbxNode *, AnimationKeys> curveKeys;
 			affectedNodes.clear();
+			curveKeys.clear();
 
 			FbxTimeSpan animTimeSpan = animStack->GetLocalTimeSpan();
 			float animStart = (float)(animTimeSpan.GetStart().GetMilliSeconds());
@@ -679,12 +1934,15 @@ namespace readers {
 							ts.translate = propName == node->LclTranslation.GetName();
 							ts.rotate = propName == node->LclRotation.GetName();
 							ts.scale = propName == node->LclScaling.GetName();
+							const double tolerance = getCurveTolerance(node, ts);
 							if (curve = prop.GetCurve(layer, FBXSDK_CURVENODE_COMPONENT_X))
-								updateAnimTime(curve, ts, animStart, animStop);
+								updateAnimTime(curve, ts, animStart, animStop, tolerance);
 							if (curve = prop.GetCurve(layer, FBXSDK_CURVENODE_COMPONENT_Y))
-								updateAnimTime(curve, ts, animStart, animStop);
+								updateAnimTime(curve, ts, animStart, animStop, tolerance);
 							if (curve = prop.GetCurve(layer, FBXSDK_CURVENODE_COMPONENT_Z))
-								updateAnimTime(curve, ts, animStart, animStop);
+								updateAnimTime(curve, ts, animStart, animStop, tolerance);
+							if (useKeyTimes())
+								addCurveKeys(prop, layer, ts, layerCount > 1, curveKeys[node]);
 							//if (ts.start < ts.stop)
 								affectedNodes[node] += ts;
 						}
@@ -692,77 +1950,488 @@ namespace readers {
 				}
 			}
 
+			// Match the clips to the animation stack, the clips of a stack without animated nodes are skipped (see addAnimations)
+			std::vector<unsigned int> stackClips;
+			float clipStart = FLT_MAX, clipStop = -FLT_MAX;
+			for (unsigned int i = 0; i < clips.size(); i++) {
+				if (clips[i].stack != (int)stackIndex)
+					continue;
+				stackClips.push_back(i);
+				clipStart = std::min(clipStart, (float)(clips[i].start.GetSecondDouble() * 1000.0));
+				clipStop = std::max(clipStop, (float)(clips[i].stop.GetSecondDouble() * 1000.0));
+			}
+
 			if (affectedNodes.empty())
 				return;
 
-			Animation *animation = new Animation();
-			model->animations.push_back(animation);
-			animation->id = animStack->GetName();
-			animStack->GetScene()->SetCurrentAnimationStack(animStack);
+			// Add an animation for the animation stack or, if it's split into clips, for each of its clips
+			Animation *animation = 0;
+			for (std::vector<unsigned int>::const_iterator itr = stackClips.begin(); itr != stackClips.end(); ++itr) {
+				AnimationClip &clip = clips[*itr];
+				clip.animation = new Animation();
+				clip.animation->id = clip.id;
+				clip.animation->loop = clip.loop;
+				model->animations.push_back(clip.animation);
+			}
+			if (stackClips.empty()) {
+				animation = new Animation();
+				model->animations.push_back(animation);
+				animation->id = animStack->GetName();
+			}
 
-			// Add the NodeAnimations to the Animation
+			// Add the NodeAnimations to the Animation, their keyframes are sampled afterwards
 			for (std::map<FbxNode *, AnimInfo>::const_iterator itr = affectedNodes.begin(); itr != affectedNodes.end(); itr++) {
 				Node *node = model->getNode((*itr).first->GetName());
-				if (!node)
+				std::map<const FbxNode *, unsigned int>::const_iterator index = nodeIndices.find((*itr).first);
+				if (!node || index == nodeIndices.end())
 					continue;
-				frames.clear();
 				NodeAnimation *nodeAnim = new NodeAnimation();
 				nodeAnim->node = node;
 				nodeAnim->translate = (*itr).second.translate;
 				nodeAnim->rotate = (*itr).second.rotate;
 				nodeAnim->scale = (*itr).second.scale;
-				const float stepSize = (*itr).second.framerate <= 0.f ? (*itr).second.stop - (*itr).second.start : 1000.f / (*itr).second.framerate;
-				const float last = (*itr).second.stop + stepSize * 0.5f;
+				nodeAnim->frameTime = getStepSize((*itr).second);
+				samples.push_back(AnimationSamples());
+				AnimationSamples &sample = samples.back();
+				sample.stack = stackIndex;
+				sample.node = (*index).second;
+				sample.info = (*itr).second;
+				sample.animStart = animStart;
+				sample.animation = animation;
+				sample.nodeAnimation = nodeAnim;
+				sample.clips = stackClips;
+				if (!stackClips.empty()) {
+					// Sample the node during all clips, also where its curves are constant
+					sample.info.start = clipStart;
+					sample.info.stop = clipStop;
+				}
+				sample.curveTangents = false;
+				if (!useKeyTimes())
+					continue;
+				// Use the keyframes at the key times instead of sampling the node if those reproduce its curves: linearly interpolated, or 
+				// as Hermite curves with the derivatives of the curves as tangents when storing the animations as curves
+				const AnimationKeys &keys = curveKeys[(*itr).first];
+				getKeyTimes(sample.info, keys.times, sample.keyTimes);
+				if (isKeyExact((*itr).first, sample.keyTimes, keys, settings->animCurves)) {
+					memcpy(sample.curves, keys.curves, sizeof(sample.curves));
+					sample.curveTangents = settings->animCurves;
+				}
+				else
+					sample.keyTimes.clear();
+			}
+		}
+
+		/** Whether to use the key times of the curves instead of sampling at the frame rate where those are as accurate. The track
+		 * codec stores key times as frame indices, so animations encoded with it are always sampled at the frame rate. */
+		inline bool useKeyTimes() const {
+			return !settings->sampleAnimations && !settings->animCodec;
+		}
+
+		/** Add the curves of the translation, rotation or scale property and their key times to the keys of the node. Linear segments 
+		 * are reproduced by linearly interpolating the keyframes at the key times, constant segments also need a keyframe just before 
+		 * the next key and cubic segments (without weighted tangents or velocity, which change the timing of the segment) are cubic 
+		 * Hermite curves with the derivatives at the keys as tangents. Curves of multiple layers are blended, so their keys aren't used. */
+		void addCurveKeys(FbxProperty &prop, FbxAnimLayer * const &layer, const AnimInfo &ts, const bool &layered, AnimationKeys &keys) {
+			static const char * const components[3] = { FBXSDK_CURVENODE_COMPONENT_X, FBXSDK_CURVENODE_COMPONENT_Y, FBXSDK_CURVENODE_COMPONENT_Z };
+			FbxAnimCurve ** const curves = keys.curves[ts.translate ? 0 : (ts.rotate ? 1 : 2)];
+			FbxTime step;
+			step.SetMilliSeconds(1);
+			keys.exact = keys.exact && !layered;
+			for (int i = 0; i < 3; i++) {
+				FbxAnimCurve * const curve = prop.GetCurve(layer, components[i]);
+				if (!curve)
+					continue;
+				keys.exact = keys.exact && !curves[i] && curve->GetPreExtrapolation() == FbxAnimCurveBase::eConstant && 
+					curve->GetPostExtrapolation() == FbxAnimCurveBase::eConstant;
+				curves[i] = curve;
+				const int keyCount = curve->KeyGetCount();
+				for (int k = 0; k < keyCount; k++) {
+					const FbxTime time = curve->KeyGetTime(k);
+					keys.times.insert(time.Get());
+					if (k + 1 == keyCount)
+						break;
+					const FbxAnimCurveDef::EInterpolationType interpolation = curve->KeyGetInterpolation(k);
+					if (interpolation == FbxAnimCurveDef::eInterpolationConstant && curve->KeyGetValue(k) != curve->KeyGetValue(k + 1)) {
+						const FbxTime next = curve->KeyGetTime(k + 1);
+						keys.constant = true;
+						keys.exact = keys.exact && curve->KeyGetConstantMode(k) == FbxAnimCurveDef::eConstantStandard;
+						if (next - time > step + step)
+							keys.times.insert((next - step).Get());
+					}
+					else if (interpolation == FbxAnimCurveDef::eInterpolationCubic) {
+						const FbxAnimCurveKey key = curve->KeyGet(k);
+						keys.cubic = true;
+						keys.exact = keys.exact && key.GetTangentWeightMode() == FbxAnimCurveDef::eWeightedNone && 
+							key.GetTangentVelocityMode() == FbxAnimCurveDef::eVelocityNone;
+					}
+				}
+			}
+		}
+
+		/** Whether interpolating the keyframes at the key times (within the time frame of the sample) reproduces the local transform of 
+		 * the node: linearly, or if hermite is true as cubic Hermite curves with the derivatives of the curves as tangents. */
+		bool isKeyExact(FbxNode * const &node, const std::vector<FbxLongLong> &times, const AnimationKeys &keys, const bool &hermite) {
+			if (!keys.exact || times.empty() || (hermite ? keys.constant : keys.cubic))
+				return false;
+			// Pivots and offsets make the translation depend on the rotation and scale
+			const FbxVector4 pivots[4] = { node->GetRotationOffset(FbxNode::eSourcePivot), node->GetRotationPivot(FbxNode::eSourcePivot), 
+				node->GetScalingOffset(FbxNode::eSourcePivot), node->GetScalingPivot(FbxNode::eSourcePivot) };
+			for (int i = 0; i < 4; i++)
+				if (pivots[i][0] != 0. || pivots[i][1] != 0. || pivots[i][2] != 0.)
+					return false;
+			FbxTime start, stop;
+			start.Set(times.front());
+			stop.Set(times.back());
+			for (int j = 0; j < 3; j++) {
+				// The scale is decomposed from the transform, which doesn't keep negative scales
+				if (FbxAnimCurve * const curve = keys.curves[2][j])
+					for (int k = 0; k < curve->KeyGetCount(); k++)
+						if (curve->KeyGetValue(k) <= 0.f)
+							return false;
+				if (!hermite)
+					continue;
+				// The rotation is a quaternion, the curves of an euler angle aren't Hermite curves of it unless they're constant
+				if (FbxAnimCurve * const curve = keys.curves[1][j])
+					for (int k = 0; curve->KeyGetCount() > 1 && k < curve->KeyGetCount(); k++)
+						if (curve->KeyGetValue(k) != curve->KeyGetValue(0) || 
+							curve->EvaluateLeftDerivative(curve->KeyGetTime(k)) != 0.f || curve->EvaluateRightDerivative(curve->KeyGetTime(k)) != 0.f)
+							return false;
+				if ((keys.curves[0][j] && !isCurveSmooth(keys.curves[0][j], start, stop)) || (keys.curves[2][j] && !isCurveSmooth(keys.curves[2][j], start, stop)))
+					return false;
+			}
+			if (hermite)
+				return true;
+			// Spherical linear interpolation reproduces a rotation about one axis, so at most one of the euler angles may change (by less
+			// than half a turn) between two key times
+			FbxTime t1, t2;
+			for (unsigned int i = 1; i < times.size(); i++) {
+				t1.Set(times[i - 1]);
+				t2.Set(times[i]);
+				int changed = 0;
+				for (int j = 0; j < 3; j++) {
+					FbxAnimCurve * const &curve = keys.curves[1][j];
+					const float angle = curve ? curve->Evaluate(t2) - curve->Evaluate(t1) : 0.f;
+					if (angle != 0.f && (++changed > 1 || angle >= 180.f || angle <= -180.f))
+						return false;
+				}
+			}
+			return true;
+		}
+
+		/** Whether the derivative of the curve is continuous within the time frame, so a single tangent at each key reproduces it. The 
+		 * value before the first and after the last key is constant. */
+		static bool isCurveSmooth(FbxAnimCurve * const &curve, const FbxTime &start, const FbxTime &stop) {
+			const int last = curve->KeyGetCount() - 1;
+			for (int k = 0; k <= last; k++) {
+				const FbxTime time = curve->KeyGetTime(k);
+				if (time < start || time > stop || last == 0)
+					continue;
+				const float left = k > 0 ? curve->EvaluateLeftDerivative(time) : (time > start ? 0.f : curve->EvaluateRightDerivative(time));
+				const float right = k < last ? curve->EvaluateRightDerivative(time) : (time < stop ? 0.f : left);
+				if (std::abs(left - right) > 0.0001f * std::max(1.f, std::max(std::abs(left), std::abs(right))))
+					return false;
+			}
+			return true;
+		}
+
+		/** The derivative (per millisecond) of the curve at the specified time, zero if the curve isn't animated */
+		static float getCurveDerivative(FbxAnimCurve * const &curve, const FbxTime &time) {
+			const int last = curve ? curve->KeyGetCount() - 1 : 0;
+			if (last <= 0)
+				return 0.f;
+			const FbxTime first = curve->KeyGetTime(0), end = curve->KeyGetTime(last);
+			// The derivative is continuous (see isCurveSmooth), so rounding the time of the keyframe doesn't matter
+			const float derivative = time >= end ? curve->EvaluateLeftDerivative(end) : curve->EvaluateRightDerivative(time < first ? first : time);
+			return derivative * 0.001f;
+		}
+
+		/** Set the tangents of the keyframe to the derivatives of the translation and scale curves, the rotation is constant */
+		static void setCurveTangents(const AnimationSamples &sample, Keyframe &kf) {
+			FbxTime time;
+			time.SetSecondDouble((kf.time + sample.animStart) * 0.001);
+			for (int j = 0; j < 3; j++) {
+				kf.translationTangent[j] = getCurveDerivative(sample.curves[0][j], time);
+				kf.scaleTangent[j] = getCurveDerivative(sample.curves[2][j], time);
+			}
+			kf.hasTangents = true;
+		}
+
+		/** The key times within the time frame of the animation, including its start and stop time */
+		void getKeyTimes(const AnimInfo &info, const std::set<FbxLongLong> &times, std::vector<FbxLongLong> &keyTimes) {
+			FbxTime start, stop;
+			start.SetMilliSeconds((FbxLongLong)info.start);
+			stop.SetMilliSeconds((FbxLongLong)info.stop);
+			// Keys closer than half a millisecond to the start or stop time are replaced by the start or stop time
+			FbxTime margin;
+			margin.SetSecondDouble(0.0005);
+			keyTimes.push_back(start.Get());
+			for (std::set<FbxLongLong>::const_iterator itr = times.begin(); itr != times.end(); ++itr)
+				if (*itr > start.Get() + margin.Get() && *itr < stop.Get() - margin.Get())
+					keyTimes.push_back(*itr);
+			if (stop.Get() > start.Get())
+				keyTimes.push_back(stop.Get());
+		}
+
+		/** The samples of the node animations of an animation stack at one time */
+		struct AnimationFrame {
+			unsigned int stack;
+			// The time as FbxTime value
+			FbxLongLong time;
+			// The node (index within the scene) and keyframe of each sample, ordered by node so parents are evaluated before their children
+			std::vector<std::pair<unsigned int, Keyframe *> > keys;
+		};
+
+		/** Sample the keyframes of all node animations. The samples are evaluated frame by frame and at each time in hierarchy order, 
+		 * so the SDK evaluates the parent chain once per frame (it caches the evaluated nodes for the current time) instead of again 
+		 * for every node at every time. The FBX SDK evaluates the current animation stack of a scene and isn't thread safe, so each 
+		 * additional thread imports its own copy of the scene. The frames are distributed over the threads, each sample is evaluated 
+		 * the same way regardless of the thread, so the result is identical to sampling on a single thread. */
+		void sampleAnimations(std::vector<AnimationSamples> &samples, const unsigned int &nodeCount, const unsigned int &stackCount) {
+			std::vector<AnimationFrame> frames;
+			getAnimationFrames(samples, frames);
+			unsigned long long sampleCount = 0;
+			for (std::vector<AnimationFrame>::const_iterator itr = frames.begin(); itr != frames.end(); ++itr)
+				sampleCount += (*itr).keys.size();
+			unsigned long long threadCount = settings->threads > 0 ? (unsigned int)settings->threads : std::thread::hardware_concurrency();
+			threadCount = std::max(1ULL, std::min(threadCount, std::min((unsigned long long)frames.size(), sampleCount / ANIMATION_SAMPLES_PER_THREAD + 1)));
+
+			std::atomic<unsigned int> next(0), failed(0);
+			std::mutex importMutex;
+			std::vector<std::thread> threads;
+			for (unsigned int t = 1; t < threadCount; t++)
+				threads.push_back(std::thread([&]() {
+					FbxManager *manager;
+					FbxScene *copy;
+					{
+						// Only one scene is imported at a time, the SDK isn't guaranteed to be thread safe while importing
+						std::lock_guard<std::mutex> lock(importMutex);
+						manager = FbxManager::Create();
+						copy = importScene(manager);
+					}
+					std::vector<FbxNode *> nodes;
+					if (copy)
+						getNodes(copy->GetRootNode(), nodes);
+					if (copy && nodes.size() == nodeCount && (unsigned int)copy->GetSrcObjectCount<FbxAnimStack>() == stackCount)
+						sampleAnimations(frames, copy, nodes, next);
+					else
+						failed++;
+					std::lock_guard<std::mutex> lock(importMutex);
+					manager->Destroy();
+				}));
+			std::vector<FbxNode *> nodes;
+			getNodes(scene->GetRootNode(), nodes);
+			sampleAnimations(frames, scene, nodes, next);
+			for (std::vector<std::thread>::iterator itr = threads.begin(); itr != threads.end(); ++itr)
+				(*itr).join();
+			if (failed > 0)
+				log->warning(log::wSourceConvertSampleAnimations, (unsigned int)failed);
+			if (!samples.empty())
+				log->verbose(log::iSourceConvertSampleAnimations, (int)samples.size(), (int)sampleCount, (int)(threadCount - failed));
+		}
+
+		/** Create the keyframes of the node animations (at the key times if those reproduce the curves and there are less of those than 
+		 * samples, otherwise at the sample times) and group them per animation stack and time */
+		void getAnimationFrames(std::vector<AnimationSamples> &samples, std::vector<AnimationFrame> &frames) {
+			// The samples ordered by stack and node index (depth first, so parents come before their children)
+			std::vector<std::pair<std::pair<unsigned int, unsigned int>, AnimationSamples *> > order;
+			for (std::vector<AnimationSamples>::iterator itr = samples.begin(); itr != samples.end(); ++itr)
+				order.push_back(std::make_pair(std::make_pair((*itr).stack, (*itr).node), &(*itr)));
+			std::sort(order.begin(), order.end());
+
+			std::map<std::pair<unsigned int, FbxLongLong>, AnimationFrame> frameMap;
+			for (std::vector<std::pair<std::pair<unsigned int, unsigned int>, AnimationSamples *> >::const_iterator itr = order.begin(); itr != order.end(); ++itr) {
+				AnimationSamples &sample = *(*itr).second;
+				const float stepSize = getStepSize(sample.info);
+				const float last = sample.info.stop + stepSize * 0.5f;
+				std::vector<float> times;
+				for (float time = sample.info.start; time <= last; time += stepSize) {
+					time = std::min(time, sample.info.stop);
+					times.push_back(time);
+				}
+				if (sample.keyTimes.size() >= times.size())
+					sample.keyTimes.clear();
 				FbxTime fbxTime;
-				// Calculate all keyframes upfront
-				for (float time = (*itr).second.start; time <= last; time += stepSize) {
-					time = std::min(time, (*itr).second.stop);
-					fbxTime.SetMilliSeconds((FbxLongLong)time);
+				for (std::vector<FbxLongLong>::const_iterator time = sample.keyTimes.begin(); time != sample.keyTimes.end(); ++time) {
 					Keyframe *kf = new Keyframe();
-					kf->time = (time - animStart);
-					FbxAMatrix *m = &(*itr).first->EvaluateLocalTransform(fbxTime);
-					FbxVector4 v = m->GetT();
-					kf->translation[0] = (float)v.mData[0];
-					kf->translation[1] = (float)v.mData[1];
-					kf->translation[2] = (float)v.mData[2];
-					FbxQuaternion q = m->GetQ();
-					kf->rotation[0] = (float)q.mData[0];
-					kf->rotation[1] = (float)q.mData[1];
-					kf->rotation[2] = (float)q.mData[2];
-					kf->rotation[3] = (float)q.mData[3];
-					v = m->GetS();
-					kf->scale[0] = (float)v.mData[0];
-					kf->scale[1] = (float)v.mData[1];
-					kf->scale[2] = (float)v.mData[2];
-					frames.push_back(kf);
-				}
-				// Only add keyframes really needed
-				addKeyframes(nodeAnim, frames);
-				if (nodeAnim->rotate || nodeAnim->scale || nodeAnim->translate)
-					animation->nodeAnimations.push_back(nodeAnim);
-				else
-					delete nodeAnim;
+					fbxTime.Set(*time);
+					kf->time = getSampleTime(sample, fbxTime);
+					sample.frames.push_back(kf);
+					addAnimationFrame(frameMap, sample, *time, kf);
+				}
+				for (std::vector<float>::const_iterator time = times.begin(); sample.keyTimes.empty() && time != times.end(); ++time) {
+					Keyframe *kf = new Keyframe();
+					kf->time = (*time - sample.animStart);
+					sample.frames.push_back(kf);
+					fbxTime.SetMilliSeconds((FbxLongLong)*time);
+					addAnimationFrame(frameMap, sample, fbxTime.Get(), kf);
+				}
+				// Each clip starts and stops with a sample at its exact start and stop time
+				for (std::vector<unsigned int>::const_iterator clip = sample.clips.begin(); clip != sample.clips.end(); ++clip) {
+					const FbxTime times[2] = { clips[*clip].start, clips[*clip].stop };
+					for (int i = 0; i < 2; i++) {
+						Keyframe *kf = new Keyframe();
+						kf->time = getSampleTime(sample, times[i]);
+						const std::vector<Keyframe *>::iterator position = std::lower_bound(sample.frames.begin(), sample.frames.end(), kf,
+							[](const Keyframe * const &a, const Keyframe * const &b) { return a->time < b->time; });
+						// Skip the time if there already is a sample at (practically) the same time
+						if ((position != sample.frames.end() && (*position)->time - kf->time < 0.001f) ||
+							(position != sample.frames.begin() && kf->time - (*(position - 1))->time < 0.001f)) {
+							delete kf;
+							continue;
+						}
+						sample.frames.insert(position, kf);
+						addAnimationFrame(frameMap, sample, times[i].Get(), kf);
+					}
+				}
+				if (sample.curveTangents && !sample.keyTimes.empty())
+					for (std::vector<Keyframe *>::const_iterator kf = sample.frames.begin(); kf != sample.frames.end(); ++kf)
+						setCurveTangents(sample, **kf);
 			}
+			frames.reserve(frameMap.size());
+			for (std::map<std::pair<unsigned int, FbxLongLong>, AnimationFrame>::const_iterator itr = frameMap.begin(); itr != frameMap.end(); ++itr)
+				frames.push_back((*itr).second);
+		}
+
+		inline static void addAnimationFrame(std::map<std::pair<unsigned int, FbxLongLong>, AnimationFrame> &frameMap, const AnimationSamples &sample, 
+			const FbxLongLong &time, Keyframe * const &kf) {
+			AnimationFrame &frame = frameMap[std::make_pair(sample.stack, time)];
+			frame.stack = sample.stack;
+			frame.time = time;
+			frame.keys.push_back(std::make_pair(sample.node, kf));
+		}
+
+		/** Sample the frames which aren't taken by another thread yet, using the specified scene */
+		void sampleAnimations(std::vector<AnimationFrame> &frames, FbxScene * const &target, const std::vector<FbxNode *> &nodes, std::atomic<unsigned int> &next) {
+			int stack = -1;
+			FbxTime fbxTime;
+			for (unsigned int i = next++; i < frames.size(); i = next++) {
+				const AnimationFrame &frame = frames[i];
+				if ((int)frame.stack != stack) {
+					stack = (int)frame.stack;
+					target->SetCurrentAnimationStack(target->GetSrcObject<FbxAnimStack>(stack));
+				}
+				fbxTime.Set(frame.time);
+				for (std::vector<std::pair<unsigned int, Keyframe *> >::const_iterator itr = frame.keys.begin(); itr != frame.keys.end(); ++itr)
+					sampleTransform(nodes[(*itr).first], fbxTime, *(*itr).second);
+			}
+		}
+
+		/** Sample the local transform of the node at the specified time of the current animation stack */
+		inline void sampleTransform(FbxNode * const &node, const FbxTime &fbxTime, Keyframe &kf) {
+			FbxAMatrix *m = &node->EvaluateLocalTransform(fbxTime);
+			FbxVector4 v = m->GetT();
+			kf.translation[0] = (float)v.mData[0];
+			kf.translation[1] = (float)v.mData[1];
+			kf.translation[2] = (float)v.mData[2];
+			FbxQuaternion q = m->GetQ();
+			kf.rotation[0] = (float)q.mData[0];
+			kf.rotation[1] = (float)q.mData[1];
+			kf.rotation[2] = (float)q.mData[2];
+			kf.rotation[3] = (float)q.mData[3];
+			v = m->GetS();
+			kf.scale[0] = (float)v.mData[0];
+			kf.scale[1] = (float)v.mData[1];
+			kf.scale[2] = (float)v.mData[2];
+		}
+
+		/** The time (in milliseconds) between two samples of the animation */
+		inline float getStepSize(const AnimInfo &info) {
+			return info.framerate <= 0.f ? info.stop - info.start : 1000.f / info.framerate;
 		}
 
-		inline void updateAnimTime(FbxAnimCurve *const &curve, AnimInfo &ts, const float &animStart, const float &animStop) {
+		/** Collect the node and its descendants (depth first) */
+		static void getNodes(FbxNode * const &node, std::vector<FbxNode *> &nodes) {
+			nodes.push_back(node);
+			for (int i = 0; i < node->GetChildCount(); i++)
+				getNodes(node->GetChild(i), nodes);
+		}
+
+		inline void updateAnimTime(FbxAnimCurve *const &curve, AnimInfo &ts, const float &animStart, const float &animStop, const double &tolerance) {
 			FbxTimeSpan fts;
 			curve->GetTimeInterval(fts);
 			const FbxTime start = fts.GetStart();
 			const FbxTime stop = fts.GetStop();
 			ts.start = std::max(animStart, std::min(ts.start, (float)(start.GetMilliSeconds())));
 			ts.stop = std::min(animStop, std::max(ts.stop, (float)stop.GetMilliSeconds()));
-			// Could check the number and type of keys (ie curve->KeyGetInterpolation) to lower the framerate
-			ts.framerate = std::max(ts.framerate, (float)stop.GetFrameRate(FbxTime::eDefaultMode));
+			const float framerate = (float)stop.GetFrameRate(FbxTime::eDefaultMode);
+			const float rate = tolerance > 0. ? framerate / getSampleStride(curve, start, stop, framerate, tolerance) : framerate;
+			ts.framerate = std::max(ts.framerate, rate);
+			if (ts.translate)
+				ts.translationRate = std::max(ts.translationRate, rate);
+			if (ts.rotate)
+				ts.rotationRate = std::max(ts.rotationRate, rate);
+			if (ts.scale)
+				ts.scaleRate = std::max(ts.scaleRate, rate);
+		}
+
+		/** The error (in the units of the curves of the channel) allowed when sampling the curves of a node coarsely: half the tolerance
+		 * of the node, so the other half remains for the reduction of the keyframes. Zero (sample every frame) without --anim-tolerance. */
+		double getCurveTolerance(FbxNode * const &node, const AnimInfo &ts) {
+			if (settings->animTolerance <= 0.f)
+				return 0.;
+			const KeyframeTolerance tolerance = getKeyframeTolerance(node);
+			// Rotation curves are euler angles in degrees
+			return 0.5 * (ts.translate ? tolerance.translation : (ts.rotate ? tolerance.rotation / FBXSDK_PI_DIV_180 : tolerance.scale));
+		}
+
+		/** The number of frames between the samples that are needed to linearly interpolate the curve within the tolerance. This is the 
+		 * largest stride for which the frames in between are interpolated within the tolerance, which captures the density of the keys 
+		 * and the frequency of the curve in between. Curves with constant (stepped) keys need every frame. */
+		int getSampleStride(FbxAnimCurve * const &curve, const FbxTime &start, const FbxTime &stop, const float &framerate, const double &tolerance) {
+			const int keyCount = curve->KeyGetCount();
+			for (int i = 0; i + 1 < keyCount; i++)
+				if (curve->KeyGetInterpolation(i) == FbxAnimCurveDef::eInterpolationConstant && curve->KeyGetValue(i) != curve->KeyGetValue(i + 1))
+					return 1;
+			if (!(framerate > 0.f))
+				return 1;
+			std::vector<double> values;
+			const double step = 1. / framerate, last = stop.GetSecondDouble();
+			FbxTime time;
+			for (double t = start.GetSecondDouble(); t <= last + step * 0.5; t += step) {
+				time.SetSecondDouble(std::min(t, last));
+				values.push_back(curve->Evaluate(time));
+			}
+			int result = 1;
+			for (int stride = 2; stride <= ANIMATION_MAX_SAMPLE_STRIDE && stride < (int)values.size() && isStrideAccurate(values, stride, tolerance); stride++)
+				result = stride;
+			return result;
+		}
+
+		/** Whether linearly interpolating every stride-th value (and the last value) reproduces the values in between within the tolerance */
+		static bool isStrideAccurate(const std::vector<double> &values, const int &stride, const double &tolerance) {
+			const int last = (int)values.size() - 1;
+			for (int i = 0; i < last; i += stride) {
+				const int j = std::min(i + stride, last);
+				for (int k = i + 1; k < j; k++)
+					if (std::abs(values[i] + (values[j] - values[i]) * (k - i) / (j - i) - values[k]) > tolerance)
+						return false;
+			}
+			return true;
 		}
 
-		void addKeyframes(NodeAnimation *const &anim, std::vector<Keyframe *> &keyframes) {
+		/** The number of samples (at the framerate of the node) between the samples of each channel (translation, rotation and scale),
+		 * rounded to the nearest stride. The reduction checks that the samples in between are within the tolerance (see reduceChannel). */
+		static void getSampleStrides(const AnimInfo &info, unsigned int (&strides)[3]) {
+			const float rates[3] = { info.translationRate, info.rotationRate, info.scaleRate };
+			for (int i = 0; i < 3; i++)
+				strides[i] = rates[i] > 0.f && info.framerate > rates[i] ? std::max(1U, (unsigned int)(info.framerate / rates[i] + 0.5f)) : 1;
+		}
+
+		void addKeyframes(NodeAnimation *const &anim, std::vector<Keyframe *> &keyframes, const unsigned int (&strides)[3]) {
 			bool translate = false, rotate = false, scale = false;
+			// q and -q are the same rotation, use the sign closest to the previous keyframe so the keyframes interpolate the shortest way
+			const float *previous = anim->node->transform.rotation;
+			for (std::vector<Keyframe *>::const_iterator itr = keyframes.begin(); itr != keyframes.end(); ++itr) {
+				float * const &q = (*itr)->rotation;
+				if (previous[0] * q[0] + previous[1] * q[1] + previous[2] * q[2] + previous[3] * q[3] < 0.f)
+					q[0] = -q[0], q[1] = -q[1], q[2] = -q[2], q[3] = -q[3];
+				previous = q;
+			}
 			// Check which components are actually changed
 			for (std::vector<Keyframe *>::const_iterator itr = keyframes.begin(); itr != keyframes.end(); ++itr) {
 				if (!translate && !cmp(anim->node->transform.translation, (*itr)->translation, 3))
 					translate = true;
-				if (!rotate && !cmp(anim->node->transform.rotation, (*itr)->rotation, 3))
+				if (!rotate && getRotationAngle(anim->node->transform.rotation, (*itr)->rotation) > KEYFRAME_ANGLE_EPSILON)
 					rotate = true;
 				if (!scale && !cmp(anim->node->transform.scale, (*itr)->scale, 3))
 					scale = true;
@@ -777,7 +2446,9 @@ namespace readers {
 				(*itr)->hasTranslation = translate;
 			}
 
-			if (!keyframes.empty()) {
+			if (settings->animTolerance > 0.f)
+				reduceKeyframes(anim, keyframes, strides);
+			else if (!keyframes.empty()) {
 				anim->keyframes.push_back(keyframes[0]);
 				const int last = (int)keyframes.size()-1;
 				Keyframe *k1 = keyframes[0], *k2, *k3;
@@ -786,7 +2457,7 @@ namespace readers {
 					k3 = keyframes[i+1];
 					// Check if the middle keyframe can be calculated by information, if so dont add it
 					if ((translate && !isLerp(k1->translation, k1->time, k2->translation, k2->time, k3->translation, k3->time, 3)) ||
-						(rotate && !isLerp(k1->rotation, k1->time, k2->rotation, k2->time, k3->rotation, k3->time, 3)) || // FIXME use slerp for quaternions
+						(rotate && getRotationError(*k1, *k2, *k3) > KEYFRAME_ANGLE_EPSILON) ||
 						(scale && !isLerp(k1->scale, k1->time, k2->scale, k2->time, k3->scale, k3->time, 3))) {
 							anim->keyframes.push_back(k2);
 							k1 = k2;
@@ -798,6 +2469,309 @@ namespace readers {
 			}
 		}
 
+		/** Encode the keyframes of all node animations with the track codec, verifying the result with the reference decoder. 
+		 * Logs the size and the largest error of the encoded keyframes. */
+		void encodeAnimations(Model * const &model) {
+			unsigned int count = 0, rawSize = 0, encodedSize = 0;
+			double translationError = 0., rotationError = 0., scaleError = 0., timeError = 0.;
+			std::vector<Keyframe> decoded;
+			for (std::vector<Animation *>::iterator itr = model->animations.begin(); itr != model->animations.end(); ++itr) {
+				for (std::vector<NodeAnimation *>::iterator it = (*itr)->nodeAnimations.begin(); it != (*itr)->nodeAnimations.end(); ++it) {
+					NodeAnimation * const &anim = *it;
+					const std::vector<Keyframe *> &keyframes = anim->keyframes;
+					bool valid = TrackCodec::encode(keyframes, anim->frameTime, anim->encodedKeyframes) &&
+						TrackCodec::decode(&anim->encodedKeyframes[0], (unsigned int)anim->encodedKeyframes.size(), decoded) && decoded.size() == keyframes.size();
+					for (unsigned int i = 0; valid && i < keyframes.size(); i++) {
+						const Keyframe &k1 = *keyframes[i], &k2 = decoded[i];
+						valid = k1.hasTranslation == k2.hasTranslation && k1.hasRotation == k2.hasRotation && k1.hasScale == k2.hasScale;
+					}
+					if (!valid) {
+						log->warning(log::wSourceConvertEncodeAnimation, (*itr)->id.c_str(), anim->node->id.c_str());
+						anim->encodedKeyframes.clear();
+						continue;
+					}
+					for (unsigned int i = 0; i < keyframes.size(); i++) {
+						const Keyframe &k1 = *keyframes[i], &k2 = decoded[i];
+						timeError = std::max(timeError, (double)std::abs(k1.time - k2.time));
+						rawSize += 4;
+						if (k1.hasTranslation) {
+							translationError = std::max(translationError, getDifference(k1.translation, k2.translation, 3, true));
+							rawSize += sizeof(k1.translation);
+						}
+						if (k1.hasRotation) {
+							rotationError = std::max(rotationError, getRotationAngle(k1.rotation, k2.rotation));
+							rawSize += sizeof(k1.rotation);
+						}
+						if (k1.hasScale) {
+							scaleError = std::max(scaleError, getDifference(k1.scale, k2.scale, 3, false));
+							rawSize += sizeof(k1.scale);
+						}
+					}
+					encodedSize += (unsigned int)anim->encodedKeyframes.size();
+					count++;
+				}
+			}
+			log->verbose(log::iSourceConvertEncodeAnimations, count, rawSize, encodedSize, translationError, rotationError / FBXSDK_PI_DIV_180, scaleError, timeError);
+		}
+
+		/** The maximum error of each channel of a node animation: the distance (in the parent space), the angle (in radians) and the scale. */
+		struct KeyframeTolerance {
+			double translation;
+			double rotation;
+			double scale;
+		};
+
+		/** The longest chain of descendants of a node: its length (including the geometry of the nodes) and number of nodes. */
+		struct Chain {
+			double length;
+			unsigned int count;
+		};
+		std::map<const FbxNode *, Chain> chains;
+
+		/** Remove the keyframes of each channel that can be interpolated within the tolerance of the node. The channels are reduced 
+		 * independently, so a keyframe might only contain some of the channels. With --anim-curves the keyframes are interpolated 
+		 * as cubic Hermite curves, using the derivative of the sampled animation (or of the curves for keyframes at the key times) at 
+		 * each keyframe as its tangent. Slow channels only consider every stride-th keyframe. */
+		void reduceKeyframes(NodeAnimation *const &anim, std::vector<Keyframe *> &keyframes, const unsigned int (&strides)[3]) {
+			if (keyframes.empty())
+				return;
+			const KeyframeTolerance tolerance = getKeyframeTolerance(anim->node->source);
+			const bool hermite = settings->animCurves;
+			if (hermite && !keyframes[0]->hasTangents)
+				calculateTangents(keyframes);
+			std::vector<bool> translation, rotation, scale;
+			if (anim->translate)
+				reduceChannel(keyframes, translation, strides[0], [&](const Keyframe &k1, const Keyframe &k, const Keyframe &k2) {
+					return (hermite ? getHermiteError(k1.translation, k1.translationTangent, k1.time, k.translation, k.time, k2.translation, k2.translationTangent, k2.time, 3, true) :
+						getLerpError(k1.translation, k1.time, k.translation, k.time, k2.translation, k2.time, 3, true)) <= tolerance.translation;
+				});
+			if (anim->rotate)
+				reduceChannel(keyframes, rotation, strides[1], [&](const Keyframe &k1, const Keyframe &k, const Keyframe &k2) {
+					return (hermite ? getHermiteRotationError(k1, k, k2) : getRotationError(k1, k, k2)) <= tolerance.rotation;
+				});
+			if (anim->scale)
+				reduceChannel(keyframes, scale, strides[2], [&](const Keyframe &k1, const Keyframe &k, const Keyframe &k2) {
+					return (hermite ? getHermiteError(k1.scale, k1.scaleTangent, k1.time, k.scale, k.time, k2.scale, k2.scaleTangent, k2.time, 3, false) :
+						getLerpError(k1.scale, k1.time, k.scale, k.time, k2.scale, k2.time, 3, false)) <= tolerance.scale;
+				});
+			for (unsigned int i = 0; i < keyframes.size(); i++) {
+				Keyframe * const &keyframe = keyframes[i];
+				keyframe->hasTranslation = anim->translate && translation[i];
+				keyframe->hasRotation = anim->rotate && rotation[i];
+				keyframe->hasScale = anim->scale && scale[i];
+				keyframe->hasTangents = hermite;
+				if (keyframe->hasTranslation || keyframe->hasRotation || keyframe->hasScale || i == 0)
+					anim->keyframes.push_back(keyframe);
+				else
+					delete keyframe;
+			}
+		}
+
+		/** Whether each keyframe is within the tolerance of the interpolation of every stride-th keyframe (and the last keyframe) around it */
+		template<class F> static bool isStrideWithinTolerance(const std::vector<Keyframe *> &keyframes, const unsigned int &stride, const F &isWithinTolerance) {
+			const unsigned int last = (unsigned int)keyframes.size() - 1;
+			for (unsigned int i = 0; i < last; i += stride) {
+				const unsigned int j = std::min(i + stride, last);
+				for (unsigned int k = i + 1; k < j; k++)
+					if (!isWithinTolerance(*keyframes[i], *keyframes[k], *keyframes[j]))
+						return false;
+			}
+			return true;
+		}
+
+		/** Mark the keyframes to keep, so that each removed keyframe is within the tolerance (as checked by isWithinTolerance(first, 
+		 * keyframe, last)) of the interpolation of the kept keyframes around it. Only every stride-th keyframe is considered (a smaller 
+		 * stride if the keyframes in between aren't within the tolerance), the first and last keyframe are always kept. */
+		template<class F> void reduceChannel(const std::vector<Keyframe *> &all, std::vector<bool> &keep, const unsigned int &stride, const F &isWithinTolerance) {
+			unsigned int step = stride;
+			while (step > 1 && !isStrideWithinTolerance(all, step, isWithinTolerance))
+				step--;
+			std::vector<unsigned int> indices;
+			for (unsigned int i = 0; i < all.size(); i += step)
+				indices.push_back(i);
+			if (indices.back() + 1 != all.size())
+				indices.push_back((unsigned int)all.size() - 1);
+			std::vector<Keyframe *> keyframes(indices.size());
+			for (unsigned int i = 0; i < indices.size(); i++)
+				keyframes[i] = all[indices[i]];
+
+			const unsigned int count = (unsigned int)keyframes.size();
+			keep.assign(all.size(), false);
+			keep[indices[0]] = keep[indices[count - 1]] = true;
+			unsigned int first = 0;
+			while (first + 1 < count) {
+				unsigned int last = first + 1;
+				for (bool valid = true; valid && last + 1 < count; ) {
+					for (unsigned int i = first + 1; valid && i <= last; i++)
+						valid = isWithinTolerance(*keyframes[first], *keyframes[i], *keyframes[last + 1]);
+					if (valid)
+						last++;
+				}
+				keep[indices[last]] = true;
+				first = last;
+			}
+		}
+
+		/** Set the tangents of the keyframes to the derivative (per millisecond) of the sampled animation, using central differences */
+		static void calculateTangents(const std::vector<Keyframe *> &keyframes) {
+			const int last = (int)keyframes.size() - 1;
+			for (int i = 0; i <= last; i++) {
+				const Keyframe &k1 = *keyframes[std::max(i - 1, 0)], &k2 = *keyframes[std::min(i + 1, last)];
+				const float dt = k2.time - k1.time;
+				const float d = dt > 0.f ? 1.f / dt : 0.f;
+				Keyframe &k = *keyframes[i];
+				for (int j = 0; j < 3; j++) {
+					k.translationTangent[j] = (k2.translation[j] - k1.translation[j]) * d;
+					k.scaleTangent[j] = (k2.scale[j] - k1.scale[j]) * d;
+				}
+				for (int j = 0; j < 4; j++)
+					k.rotationTangent[j] = (k2.rotation[j] - k1.rotation[j]) * d;
+			}
+		}
+
+		/** Evaluate the cubic Hermite curve between (t1, v1) and (t2, v2) with the tangents (per time unit) m1 and m2 at time t */
+		template<class T> static void hermite(const float *v1, const float *m1, const float &t1, const float *v2, const float *m2, const float &t2, 
+				const float &t, const int &size, T * const result) {
+			const double h = t2 - t1, s = h > 0. ? (t - t1) / h : 0., s2 = s * s, s3 = s2 * s;
+			const double h00 = 2. * s3 - 3. * s2 + 1., h10 = s3 - 2. * s2 + s, h01 = -2. * s3 + 3. * s2, h11 = s3 - s2;
+			for (int i = 0; i < size; i++)
+				result[i] = (T)(h00 * v1[i] + h10 * h * m1[i] + h01 * v2[i] + h11 * h * m2[i]);
+		}
+
+		/** The distance (or the largest difference of the components if not euclidean) between v and the Hermite curve from v1 to v2 at time t */
+		static double getHermiteError(const float *v1, const float *m1, const float &t1, const float *v, const float &t, const float *v2, const float *m2, const float &t2, 
+				const int &size, const bool &euclidean) {
+			double p[4], result = 0.;
+			hermite(v1, m1, t1, v2, m2, t2, t, size, p);
+			for (int i = 0; i < size; i++) {
+				const double e = p[i] - v[i];
+				result = euclidean ? result + e * e : std::max(result, e < 0. ? -e : e);
+			}
+			return euclidean ? sqrt(result) : result;
+		}
+
+		/** The angle (in radians) between the rotation of k and the (normalized) Hermite curve of the rotations of k1 and k2 */
+		static double getHermiteRotationError(const Keyframe &k1, const Keyframe &k, const Keyframe &k2) {
+			double q[4];
+			hermite(k1.rotation, k1.rotationTangent, k1.time, k2.rotation, k2.rotationTangent, k2.time, k.time, 4, q);
+			return getRotationAngle(q, k.rotation);
+		}
+
+		/** The distance (or the largest difference of the components if not euclidean) between v1 and v2 */
+		static double getDifference(const float *v1, const float *v2, const int &size, const bool &euclidean) {
+			double result = 0.;
+			for (int i = 0; i < size; i++) {
+				const double e = (double)v1[i] - v2[i];
+				result = euclidean ? result + e * e : std::max(result, e < 0. ? -e : e);
+			}
+			return euclidean ? sqrt(result) : result;
+		}
+
+		/** The distance (or the largest difference of the components if not euclidean) between v and the linear interpolation of v1 and v2 at time t */
+		static double getLerpError(const float *v1, const float &t1, const float *v, const float &t, const float *v2, const float &t2, const int &size, const bool &euclidean) {
+			const double d = t2 > t1 ? (t - t1) / (t2 - t1) : 0.;
+			double result = 0.;
+			for (int i = 0; i < size; i++) {
+				const double e = v1[i] + d * (v2[i] - v1[i]) - v[i];
+				result = euclidean ? result + e * e : std::max(result, e < 0. ? -e : e);
+			}
+			return euclidean ? sqrt(result) : result;
+		}
+
+		/** The angle (in radians) between the rotation of k and the spherical linear interpolation (as used at runtime) of the rotations 
+		 * of k1 and k2 */
+		static double getRotationError(const Keyframe &k1, const Keyframe &k, const Keyframe &k2) {
+			const double t = k2.time > k1.time ? (k.time - k1.time) / (k2.time - k1.time) : 0.;
+			double q1[4], q2[4], q[4], dot = 0.;
+			normalize(k1.rotation, q1);
+			normalize(k2.rotation, q2);
+			for (int i = 0; i < 4; i++)
+				dot += q1[i] * q2[i];
+			const double sign = dot < 0. ? -1. : 1.;
+			dot *= sign;
+			double w1 = 1. - t, w2 = t;
+			// Close rotations are linearly interpolated (and normalized) to avoid dividing by a sine close to zero
+			if (dot < 0.9999) {
+				const double angle = acos(dot), sine = sin(angle);
+				w1 = sin((1. - t) * angle) / sine;
+				w2 = sin(t * angle) / sine;
+			}
+			for (int i = 0; i < 4; i++)
+				q[i] = w1 * q1[i] + w2 * sign * q2[i];
+			return getRotationAngle(q, k.rotation);
+		}
+
+		/** The angle (in radians) of the rotation from q1 to q2, regardless of the sign of the quaternions */
+		template<class S, class T> static double getRotationAngle(const S * const q1, const T * const q2) {
+			double a[4], b[4], dot = 0., chord = 0.;
+			normalize(q1, a);
+			normalize(q2, b);
+			for (int i = 0; i < 4; i++)
+				dot += a[i] * b[i];
+			const double sign = dot < 0. ? -1. : 1.;
+			for (int i = 0; i < 4; i++)
+				chord += (a[i] - sign * b[i]) * (a[i] - sign * b[i]);
+			// The chord between unit quaternions is 2 * sin(angle / 4), which (unlike the dot product) is accurate for small angles
+			return 4. * asin(std::min(1., sqrt(chord) * 0.5));
+		}
+
+		template<class T> inline static void normalize(const T * const q, double (&out)[4]) {
+			double length = 0.;
+			for (int i = 0; i < 4; i++)
+				length += (double)q[i] * q[i];
+			length = length > 0. ? 1. / sqrt(length) : 0.;
+			for (int i = 0; i < 4; i++)
+				out[i] = q[i] * length;
+		}
+
+		/** The tolerance of the channels of the node, so that the error of the node and its descendants stays within the distance and 
+		 * angle tolerance. The errors of the nodes in a chain add up, so the tolerance is divided over the nodes of the longest chain through 
+		 * the node. A rotation or scale error moves the descendants (and the geometry) proportional to their distance to the node. */
+		KeyframeTolerance getKeyframeTolerance(FbxNode * const &node) {
+			const Chain &chain = getChain(node);
+			unsigned int depth = 0;
+			for (FbxNode *parent = node->GetParent(); parent != 0 && parent != scene->GetRootNode(); parent = parent->GetParent())
+				depth++;
+			const double count = (double)(depth + chain.count);
+			const double distance = settings->animTolerance / count;
+			const double angle = settings->animAngleTolerance * FBXSDK_PI_DIV_180 / count;
+			const double parentScale = node->GetParent() != 0 ? getMaxComponent(node->GetParent()->EvaluateGlobalTransform().GetS()) : 1.;
+			const double scale = getMaxComponent(node->EvaluateLocalTransform().GetS());
+			KeyframeTolerance result;
+			result.translation = parentScale > 0. ? distance / parentScale : distance;
+			result.rotation = chain.length > 0. ? std::min(angle, distance / chain.length) : angle;
+			result.scale = scale * (chain.length > 0. ? std::min(angle, distance / chain.length) : angle);
+			return result;
+		}
+
+		const Chain &getChain(FbxNode * const &node) {
+			std::map<const FbxNode *, Chain>::const_iterator itr = chains.find(node);
+			if (itr != chains.end())
+				return itr->second;
+			Chain result;
+			result.count = 1;
+			result.length = 0.;
+			const FbxAMatrix transform = node->EvaluateGlobalTransform();
+			const FbxVector4 origin = transform.GetT();
+			if (FbxMesh * const mesh = node->GetMesh()) {
+				const int pointCount = mesh->GetControlPointsCount();
+				for (int i = 0; i < pointCount; i++)
+					result.length = std::max(result.length, (transform.MultT(mesh->GetControlPointAt(i)) - origin).Length());
+			}
+			const int childCount = node->GetChildCount();
+			for (int i = 0; i < childCount; i++) {
+				FbxNode * const child = node->GetChild(i);
+				const Chain &chain = getChain(child);
+				result.length = std::max(result.length, (child->EvaluateGlobalTransform().GetT() - origin).Length() + chain.length);
+				result.count = std::max(result.count, chain.count + 1);
+			}
+			return chains[node] = result;
+		}
+
+		inline static double getMaxComponent(const FbxVector4 &v) {
+			return std::max(std::abs(v[0]), std::max(std::abs(v[1]), std::abs(v[2])));
+		}
+
 		inline bool cmp(const float &v1, const float &v2, const float &epsilon = 0.000001) {
 			const double d = v1 - v2;
 			return ((d < 0.f) ? -d : d) < epsilon;
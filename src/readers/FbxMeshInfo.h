@@ -54,6 +54,8 @@ namespace readers {
 		Attributes attributes;
 		// Whether to use packed colors
 		const bool _usePackedColors;
+		// Whether to store the normal, tangent and binormal as a single quaternion (QTangent)
+		const bool _useQTangents;
 		// The number of polygon (triangles if triangulated)
 		//const unsigned int _polyCount;
 		// The number of control points within the mesh
@@ -76,7 +78,7 @@ namespace readers {
 		unsigned int * _polyPartMap;
 		// Mapping between the polygon and the index of its weight bones within its meshpart
 		unsigned int * _polyPartBonesMap;
-		// The UV bounds per part per uv coords
+		// The UV bounds (min u, min v, max u, max v) per part per uv coords, the minimum exceeds the maximum if the part has no polygons
 		float * _partUVBounds;
 		// The mapping name of each uv to identify the cooresponding texture
 		std::string uvMapping[8];
@@ -103,21 +105,23 @@ namespace readers {
 
 		fbxconv::log::Log *log;
 
-        FbxMeshInfo(fbxconv::log::Log *log, const std::string& meshName,FbxMesh * const &mesh, const bool &usePackedColors, const unsigned int &maxVertexBlendWeightCount, const bool &forceMaxVertexBlendWeightCount, const unsigned int &maxNodePartBoneCount)
-			: _meshName(meshName), _mesh(mesh), log(log),
-			_usePackedColors(usePackedColors),
+        FbxMeshInfo(fbxconv::log::Log *log, const std::string& meshName,FbxMesh * const &mesh, const bool &usePackedColors, const unsigned int &maxVertexBlendWeightCount, const bool &forceMaxVertexBlendWeightCount, const unsigned int &maxNodePartBoneCount, const bool &useQTangents = false)
+			: _mesh(mesh), _meshName(meshName),
+			id(getID(mesh)),
 			maxVertexBlendWeightCount(4),
 			vertexBlendWeightCount(0),
 			_forceMaxVertexBlendWeightCount(true),
+			bonesOverflow(false),
+			_usePackedColors(usePackedColors),
+			_useQTangents(useQTangents),
 			//_pointCount(mesh->GetControlPointsCount()),
 			//_polyCount(mesh->GetPolygonCount()),
 			//_points(mesh->GetControlPoints()),
 			//elementMaterialCount(mesh->GetElementMaterialCount()),
 			uvCount((unsigned int)(mesh->GetElementUVCount() > 8 ? 8 : mesh->GetElementUVCount())),
-			_pointBlendWeights(0),
 			skin((maxNodePartBoneCount > 0 && maxVertexBlendWeightCount > 0 && (unsigned int)mesh->GetDeformerCount(FbxDeformer::eSkin) > 0) ? static_cast<FbxSkin*>(mesh->GetDeformer(0, FbxDeformer::eSkin)) : 0),
-			bonesOverflow(false),
-			id(getID(mesh))
+			_pointBlendWeights(0),
+			log(log)
 		{
             _polyPartMap = getPolyCount() > 0 ? new unsigned int[getPolyCount()] : 0;
             _polyPartBonesMap = getPolyCount() > 0 ? new unsigned int[getPolyCount()] : 0;
@@ -127,8 +131,10 @@ namespace readers {
 			_partUVBounds = _meshPartCount * uvCount > 0 ? new float[4 * _meshPartCount * uvCount] : 0;
 			memset(_polyPartMap, -1, sizeof(unsigned int) * getPolyCount());
 			memset(_polyPartBonesMap, 0, sizeof(unsigned int) * getPolyCount());
-			if (_partUVBounds)
-				memset(_partUVBounds, -1, sizeof(float) * 4 * _meshPartCount * uvCount);
+			for (unsigned int i = 0; _partUVBounds && i < _meshPartCount * uvCount; i++) {
+				_partUVBounds[4*i] = _partUVBounds[4*i+1] = FLT_MAX;
+				_partUVBounds[4*i+2] = _partUVBounds[4*i+3] = -FLT_MAX;
+			}
 
 			if (skin) {
 				fetchVertexBlendWeights();
@@ -208,6 +214,22 @@ namespace readers {
 			data[offset++] = (float)tmpV4.mData[2];
 		}
 
+		inline void getQTangent(float * const &data, unsigned int &offset, const unsigned int &polyIndex, const unsigned int &point) const {
+			static FbxVector4 normal, tangent, binormal;
+			getNormal(&normal, polyIndex, point);
+			getTangent(&tangent, polyIndex, point);
+			if (binormals)
+				getBinormal(&binormal, polyIndex, point);
+			else {
+				// Without binormals, the handedness might be stored in the w component of the tangent
+				binormal = normal.CrossProduct(tangent);
+				if (tangent.mData[3] < 0.)
+					binormal = -binormal;
+			}
+			toQTangent(normal.mData, tangent.mData, binormal.mData, &data[offset]);
+			offset += 4;
+		}
+
 		inline void getColor(FbxColor * const &out, const unsigned int &polyIndex, const unsigned int &point) const {
 			((FbxLayerElementArray*)colors)->GetAt<FbxColor>(colorOnPoint ? (colorIndices ? (*colorIndices)[point] : point) : (colorIndices ? (*colorIndices)[polyIndex] : polyIndex), out);
 			//return colorOnPoint ? (*colors)[colorIndices ? (*colorIndices)[point] : point] : (*colors)[colorIndices ? (*colorIndices)[polyIndex] : polyIndex];
@@ -272,6 +294,8 @@ namespace readers {
 				getUV(data, offset, i, polyIndex, point, uvTransforms[i]);
             if(attributes.hasBlendInfo())
                 getBlendInfos(data, offset, poly, polyIndex, point);
+			if (attributes.hasQTangent())
+				getQTangent(data, offset, polyIndex, point);
 		}
 
 		inline void getVertex(float * const &data, const unsigned int &poly, const unsigned int &polyIndex, const unsigned int &point, const Matrix3<float> * const &uvTransforms) const {
@@ -305,32 +329,39 @@ namespace readers {
 		}
 
 		void fetchAttributes() {
+			const bool qtangent = _useQTangents && _mesh->GetElementNormalCount() > 0 && _mesh->GetElementTangentCount() > 0;
 			attributes.hasPosition(true);
-			attributes.hasNormal(_mesh->GetElementNormalCount() > 0);
+			attributes.hasNormal(!qtangent && _mesh->GetElementNormalCount() > 0);
 			attributes.hasColor((!_usePackedColors) && (_mesh->GetElementVertexColorCount() > 0));
 			attributes.hasColorPacked(_usePackedColors && (_mesh->GetElementVertexColorCount() > 0));
-			attributes.hasTangent(_mesh->GetElementTangentCount() > 0);
-			attributes.hasBinormal(_mesh->GetElementBinormalCount() > 0);
+			attributes.hasTangent(!qtangent && _mesh->GetElementTangentCount() > 0);
+			attributes.hasBinormal(!qtangent && _mesh->GetElementBinormalCount() > 0);
+			attributes.hasQTangent(qtangent);
 			for (unsigned int i = 0; i < 8; i++)
 				attributes.hasUV(i, i < uvCount);
             attributes.hasBlendInfo(vertexBlendWeightCount > 0);
 		}
 
 		void cacheAttributes() {
+			// The QTangent is calculated from the normals, tangents and (if available) binormals
+			const bool hasNormals = attributes.hasNormal() || attributes.hasQTangent();
+			const bool hasTangents = attributes.hasTangent() || attributes.hasQTangent();
+			const bool hasBinormals = attributes.hasBinormal() || (attributes.hasQTangent() && _mesh->GetElementBinormalCount() > 0);
+
 			// Cache normals, whether they are indexed and if they are located on control points or polygon points.
-			normals = attributes.hasNormal() ? &(_mesh->GetElementNormal()->GetDirectArray()) : 0;
-			normalIndices = attributes.hasNormal() && _mesh->GetElementNormal()->GetReferenceMode() == FbxGeometryElement::eIndexToDirect ? &(_mesh->GetElementNormal()->GetIndexArray()) : 0;
-			normalOnPoint = attributes.hasNormal() ? _mesh->GetElementNormal()->GetMappingMode() == FbxGeometryElement::eByControlPoint : false;
+			normals = hasNormals ? &(_mesh->GetElementNormal()->GetDirectArray()) : 0;
+			normalIndices = hasNormals && _mesh->GetElementNormal()->GetReferenceMode() == FbxGeometryElement::eIndexToDirect ? &(_mesh->GetElementNormal()->GetIndexArray()) : 0;
+			normalOnPoint = hasNormals ? _mesh->GetElementNormal()->GetMappingMode() == FbxGeometryElement::eByControlPoint : false;
 
 			// Cache tangents, whether they are indexed and if they are located on control points or polygon points.
-			tangents = attributes.hasTangent() ? &(_mesh->GetElementTangent()->GetDirectArray()) : 0;
-			tangentIndices = attributes.hasTangent() && _mesh->GetElementTangent()->GetReferenceMode() == FbxGeometryElement::eIndexToDirect ? &(_mesh->GetElementTangent()->GetIndexArray()) : 0;
-			tangentOnPoint = attributes.hasTangent() ? _mesh->GetElementTangent()->GetMappingMode() == FbxGeometryElement::eByControlPoint : false;
+			tangents = hasTangents ? &(_mesh->GetElementTangent()->GetDirectArray()) : 0;
+			tangentIndices = hasTangents && _mesh->GetElementTangent()->GetReferenceMode() == FbxGeometryElement::eIndexToDirect ? &(_mesh->GetElementTangent()->GetIndexArray()) : 0;
+			tangentOnPoint = hasTangents ? _mesh->GetElementTangent()->GetMappingMode() == FbxGeometryElement::eByControlPoint : false;
 			
 			// Cache binormals, whether they are indexed and if they are located on control points or polygon points.
-			binormals = attributes.hasBinormal() ? &(_mesh->GetElementBinormal()->GetDirectArray()) : 0;
-			binormalIndices = attributes.hasBinormal() && _mesh->GetElementBinormal()->GetReferenceMode() == FbxGeometryElement::eIndexToDirect ? &(_mesh->GetElementBinormal()->GetIndexArray()) : 0;
-			binormalOnPoint = attributes.hasBinormal() ? _mesh->GetElementBinormal()->GetMappingMode() == FbxGeometryElement::eByControlPoint : false;
+			binormals = hasBinormals ? &(_mesh->GetElementBinormal()->GetDirectArray()) : 0;
+			binormalIndices = hasBinormals && _mesh->GetElementBinormal()->GetReferenceMode() == FbxGeometryElement::eIndexToDirect ? &(_mesh->GetElementBinormal()->GetIndexArray()) : 0;
+			binormalOnPoint = hasBinormals ? _mesh->GetElementBinormal()->GetMappingMode() == FbxGeometryElement::eByControlPoint : false;
 
 			// Cache colors, whether they are indexed and if they are located on control points or polygon points.
 			colors = (attributes.hasColor() || attributes.hasColorPacked()) ? &(_mesh->GetElementVertexColor()->GetDirectArray()) : 0;
@@ -444,13 +475,13 @@ namespace readers {
 						for (unsigned int j = 0; j < uvCount; j++) {
 							getUV(&uv, j, pidx, v);
 							idx = 4 * (mp * uvCount + j);
-							if (*(int*)&_partUVBounds[idx]==-1 || uv.mData[0] < _partUVBounds[idx])
+							if (uv.mData[0] < _partUVBounds[idx])
 								_partUVBounds[idx] = (float)uv.mData[0];
-							if (*(int*)&_partUVBounds[idx+1]==-1 || uv.mData[1] < _partUVBounds[idx+1])
+							if (uv.mData[1] < _partUVBounds[idx+1])
 								_partUVBounds[idx+1] = (float)uv.mData[1];
-							if (*(int*)&_partUVBounds[idx+2]==-1 || uv.mData[0] > _partUVBounds[idx+2])
+							if (uv.mData[0] > _partUVBounds[idx+2])
 								_partUVBounds[idx+2] = (float)uv.mData[0];
-							if (*(int*)&_partUVBounds[idx+3]==-1 || uv.mData[1] > _partUVBounds[idx+3])
+							if (uv.mData[1] > _partUVBounds[idx+3])
 								_partUVBounds[idx+3] = (float)uv.mData[1];
 						}
 					}
@@ -0,0 +1,229 @@
+/*******************************************************************************
+ * Copyright 2011 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#ifdef _MSC_VER
+#pragma once
+#endif //_MSC_VER
+#ifndef FBXCONV_READERS_MESHPACKER_H
+#define FBXCONV_READERS_MESHPACKER_H
+
+#include <vector>
+#include <algorithm>
+#include <map>
+
+namespace fbxconv {
+namespace readers {
+	// A mesh that should be placed in one of the vertex buffers (bins) of the packer
+	struct MeshPackItem {
+		// The amount of vertices and indices the mesh contains
+		unsigned int vertexCount;
+		unsigned int indexCount;
+		// Only items within the same group (e.g. with the same attributes) can share a bin
+		unsigned long group;
+		// The position of the item along a locality curve (hierarchy order or spatial curve), in the range 0..1
+		double locality;
+		// The bin the item is placed in, set by MeshPacker::pack
+		int bin;
+
+		MeshPackItem() : vertexCount(0), indexCount(0), group(0), locality(0.), bin(-1) {}
+	};
+
+	// The content of a single bin after packing
+	struct MeshPackBin {
+		unsigned long group;
+		unsigned int vertexCount;
+		unsigned int indexCount;
+		unsigned int itemCount;
+		double locality;
+
+		MeshPackBin(const unsigned long &group = 0) : group(group), vertexCount(0), indexCount(0), itemCount(0), locality(0.) {}
+	};
+
+	// Packs meshes into the fewest possible vertex buffers, while trying to keep meshes that are close to each other together.
+	// This is a best-fit decreasing packer in two dimensions (vertices and indices), where the locality of the item is used as
+	// a penalty when choosing between bins the item fits in. Afterwards it tries to empty the least utilized bins.
+	class MeshPacker {
+	public:
+		const unsigned int maxVertexCount;
+		const unsigned int maxIndexCount;
+		// The weight of the locality penalty relative to the wasted space when choosing a bin
+		double localityWeight;
+		// The resulting bins
+		std::vector<MeshPackBin> bins;
+		// The minimum amount of bins required to fit all items, regardless of the packing
+		unsigned int lowerBound;
+
+		MeshPacker(const unsigned int &maxVertexCount, const unsigned int &maxIndexCount, const double &localityWeight = 0.25)
+			: maxVertexCount(maxVertexCount), maxIndexCount(maxIndexCount), localityWeight(localityWeight), lowerBound(0) {}
+
+		/** Assign a bin to each item, returns the number of bins used. */
+		unsigned int pack(std::vector<MeshPackItem> &items) {
+			bins.clear();
+			lowerBound = 0;
+
+			std::map<unsigned long, std::vector<MeshPackItem *> > groups;
+			for (std::vector<MeshPackItem>::iterator itr = items.begin(); itr != items.end(); ++itr)
+				groups[(*itr).group].push_back(&(*itr));
+
+			for (std::map<unsigned long, std::vector<MeshPackItem *> >::iterator itr = groups.begin(); itr != groups.end(); ++itr)
+				packGroup(itr->first, itr->second);
+
+			return (unsigned int)bins.size();
+		}
+
+		/** The fraction of the vertex buffer that is used by the bin */
+		inline double vertexUtilization(const MeshPackBin &bin) const {
+			return maxVertexCount > 0 ? (double)bin.vertexCount / (double)maxVertexCount : 1.;
+		}
+
+		/** The fraction of the index buffer that is used by the bin */
+		inline double indexUtilization(const MeshPackBin &bin) const {
+			return maxIndexCount > 0 ? (double)bin.indexCount / (double)maxIndexCount : 1.;
+		}
+
+	private:
+		inline double size(const MeshPackItem * const &item) const {
+			return std::max((double)item->vertexCount / (double)std::max(maxVertexCount, 1U), (double)item->indexCount / (double)std::max(maxIndexCount, 1U));
+		}
+
+		inline bool fits(const MeshPackBin &bin, const MeshPackItem * const &item) const {
+			return bin.vertexCount + item->vertexCount <= maxVertexCount && bin.indexCount + item->indexCount <= maxIndexCount;
+		}
+
+		inline void place(const int &binIndex, MeshPackItem * const &item) {
+			MeshPackBin &bin = bins[binIndex];
+			bin.locality = (bin.locality * bin.itemCount + item->locality) / (bin.itemCount + 1);
+			bin.vertexCount += item->vertexCount;
+			bin.indexCount += item->indexCount;
+			bin.itemCount++;
+			item->bin = binIndex;
+		}
+
+		inline void remove(MeshPackItem * const &item) {
+			MeshPackBin &bin = bins[item->bin];
+			bin.vertexCount -= item->vertexCount;
+			bin.indexCount -= item->indexCount;
+			bin.locality = bin.itemCount > 1 ? (bin.locality * bin.itemCount - item->locality) / (bin.itemCount - 1) : 0.;
+			bin.itemCount--;
+			item->bin = -1;
+		}
+
+		// The cost of placing the item in the bin, lower is better, negative if it doesn't fit
+		inline double cost(const MeshPackBin &bin, const MeshPackItem * const &item) const {
+			if (!fits(bin, item))
+				return -1.;
+			const double vertexWaste = 1. - (double)(bin.vertexCount + item->vertexCount) / (double)std::max(maxVertexCount, 1U);
+			const double indexWaste = 1. - (double)(bin.indexCount + item->indexCount) / (double)std::max(maxIndexCount, 1U);
+			const double distance = bin.locality > item->locality ? bin.locality - item->locality : item->locality - bin.locality;
+			return std::min(vertexWaste, indexWaste) + localityWeight * distance;
+		}
+
+		int findBin(const unsigned int &first, const unsigned int &last, const MeshPackItem * const &item, const int &exclude = -1) const {
+			int result = -1;
+			double best = 0.;
+			for (unsigned int i = first; i < last; i++) {
+				if ((int)i == exclude)
+					continue;
+				const double c = cost(bins[i], item);
+				if (c >= 0. && (result < 0 || c < best)) {
+					best = c;
+					result = (int)i;
+				}
+			}
+			return result;
+		}
+
+		struct SizeComparator {
+			const MeshPacker * const packer;
+			SizeComparator(const MeshPacker * const &packer) : packer(packer) {}
+			inline bool operator()(const MeshPackItem * const &lhs, const MeshPackItem * const &rhs) const {
+				const double l = packer->size(lhs), r = packer->size(rhs);
+				return l != r ? l > r : lhs->locality < rhs->locality;
+			}
+		};
+
+		void packGroup(const unsigned long &group, std::vector<MeshPackItem *> &items) {
+			const unsigned int first = (unsigned int)bins.size();
+			unsigned long long totalVertices = 0, totalIndices = 0;
+			for (std::vector<MeshPackItem *>::const_iterator itr = items.begin(); itr != items.end(); ++itr) {
+				totalVertices += (*itr)->vertexCount;
+				totalIndices += (*itr)->indexCount;
+			}
+			const unsigned long long vertexBins = maxVertexCount > 0 ? (totalVertices + maxVertexCount - 1) / maxVertexCount : items.size();
+			const unsigned long long indexBins = maxIndexCount > 0 ? (totalIndices + maxIndexCount - 1) / maxIndexCount : items.size();
+			lowerBound += (unsigned int)std::max(std::max(vertexBins, indexBins), 1ULL);
+
+			std::sort(items.begin(), items.end(), SizeComparator(this));
+			for (std::vector<MeshPackItem *>::iterator itr = items.begin(); itr != items.end(); ++itr) {
+				int bin = findBin(first, (unsigned int)bins.size(), *itr);
+				if (bin < 0) {
+					bin = (int)bins.size();
+					bins.push_back(MeshPackBin(group));
+				}
+				place(bin, *itr);
+			}
+
+			// Try to empty the least utilized bins by moving their items to other bins
+			bool changed = true;
+			while (changed) {
+				changed = false;
+				int emptiest = -1;
+				for (unsigned int i = first; i < bins.size(); i++)
+					if (bins[i].itemCount > 0 && (emptiest < 0 || std::max(vertexUtilization(bins[i]), indexUtilization(bins[i])) <
+							std::max(vertexUtilization(bins[emptiest]), indexUtilization(bins[emptiest]))))
+						emptiest = (int)i;
+				if (emptiest < 0)
+					break;
+				std::vector<std::pair<MeshPackItem *, int> > moved;
+				bool success = true;
+				for (std::vector<MeshPackItem *>::iterator itr = items.begin(); success && itr != items.end(); ++itr) {
+					if ((*itr)->bin != emptiest)
+						continue;
+					const int bin = findBin(first, (unsigned int)bins.size(), *itr, emptiest);
+					if (bin < 0)
+						success = false;
+					else {
+						remove(*itr);
+						place(bin, *itr);
+						moved.push_back(std::make_pair(*itr, emptiest));
+					}
+				}
+				if (success)
+					changed = true;
+				else {
+					// Undo the moves, the bin can't be emptied
+					for (std::vector<std::pair<MeshPackItem *, int> >::iterator itr = moved.begin(); itr != moved.end(); ++itr) {
+						remove(itr->first);
+						place(itr->second, itr->first);
+					}
+				}
+			}
+
+			// Remove the emptied bins
+			std::vector<int> remap(bins.size() - first, -1);
+			unsigned int n = first;
+			for (unsigned int i = first; i < bins.size(); i++) {
+				if (bins[i].itemCount == 0)
+					continue;
+				remap[i - first] = (int)n;
+				bins[n++] = bins[i];
+			}
+			bins.resize(n);
+			for (std::vector<MeshPackItem *>::iterator itr = items.begin(); itr != items.end(); ++itr)
+				(*itr)->bin = remap[(*itr)->bin - first];
+		}
+	};
+} }
+#endif //FBXCONV_READERS_MESHPACKER_H
@@ -23,6 +23,7 @@
 #include <vector>
 #include <algorithm>
 #include <assert.h>
+#include <math.h>
 
 namespace fbxconv {
 namespace readers {
@@ -171,21 +172,107 @@ namespace readers {
 		}
 	};
 
+	// The smallest magnitude of the w component of a qtangent, so its sign (the handedness) survives 16-bit quantization
+	#define QTANGENT_BIAS (1.0 / 32767.0)
+
+	/** Convert the tangent frame to a quaternion (QTangent) with the handedness of the binormal stored in the sign of w. 
+	 * The tangent is orthogonalized against the normal, the binormal is only used for its handedness and may be 0. */
+	inline void toQTangent(const double * const &normal, const double * const &tangent, const double * const &binormal, float * const &out) {
+		double n[3] = {normal[0], normal[1], normal[2]}, t[3], b[3];
+		double len = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+		if (len <= 0.) {
+			n[0] = n[1] = 0.; n[2] = len = 1.;
+		}
+		for (int i = 0; i < 3; i++)
+			n[i] /= len;
+		const double d = n[0]*tangent[0] + n[1]*tangent[1] + n[2]*tangent[2];
+		for (int i = 0; i < 3; i++)
+			t[i] = tangent[i] - n[i] * d;
+		len = sqrt(t[0]*t[0] + t[1]*t[1] + t[2]*t[2]);
+		if (len <= 1e-12) {
+			// Any tangent perpendicular to the normal
+			const double a[3] = {fabs(n[0]) < 0.9 ? 1. : 0., fabs(n[0]) < 0.9 ? 0. : 1., 0.};
+			t[0] = a[1]*n[2] - a[2]*n[1]; t[1] = a[2]*n[0] - a[0]*n[2]; t[2] = a[0]*n[1] - a[1]*n[0];
+			len = sqrt(t[0]*t[0] + t[1]*t[1] + t[2]*t[2]);
+		}
+		for (int i = 0; i < 3; i++)
+			t[i] /= len;
+		b[0] = n[1]*t[2] - n[2]*t[1]; b[1] = n[2]*t[0] - n[0]*t[2]; b[2] = n[0]*t[1] - n[1]*t[0];
+		const bool mirrored = binormal != 0 && (b[0]*binormal[0] + b[1]*binormal[1] + b[2]*binormal[2]) < 0.;
+
+		// The rotation matrix with the columns tangent, binormal and normal
+		double q[4]; // x, y, z, w
+		const double trace = t[0] + b[1] + n[2];
+		if (trace > 0.) {
+			const double s = sqrt(trace + 1.) * 2.;
+			q[3] = 0.25 * s; q[0] = (b[2] - n[1]) / s; q[1] = (n[0] - t[2]) / s; q[2] = (t[1] - b[0]) / s;
+		}
+		else if (t[0] > b[1] && t[0] > n[2]) {
+			const double s = sqrt(1. + t[0] - b[1] - n[2]) * 2.;
+			q[3] = (b[2] - n[1]) / s; q[0] = 0.25 * s; q[1] = (b[0] + t[1]) / s; q[2] = (n[0] + t[2]) / s;
+		}
+		else if (b[1] > n[2]) {
+			const double s = sqrt(1. + b[1] - t[0] - n[2]) * 2.;
+			q[3] = (n[0] - t[2]) / s; q[0] = (b[0] + t[1]) / s; q[1] = 0.25 * s; q[2] = (n[1] + b[2]) / s;
+		}
+		else {
+			const double s = sqrt(1. + n[2] - t[0] - b[1]) * 2.;
+			q[3] = (t[1] - b[0]) / s; q[0] = (n[0] + t[2]) / s; q[1] = (n[1] + b[2]) / s; q[2] = 0.25 * s;
+		}
+		len = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+		for (int i = 0; i < 4; i++)
+			q[i] /= (q[3] < 0. ? -len : len);
+		if (q[3] < QTANGENT_BIAS) {
+			const double xyz = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2]);
+			const double scale = xyz > 0. ? sqrt(1. - QTANGENT_BIAS * QTANGENT_BIAS) / xyz : 0.;
+			for (int i = 0; i < 3; i++)
+				q[i] *= scale;
+			q[3] = QTANGENT_BIAS;
+		}
+		for (int i = 0; i < 4; i++)
+			out[i] = (float)(mirrored ? -q[i] : q[i]);
+	}
+
+	/** Convert the quaternion (QTangent) back to the tangent frame, the binormal includes the handedness */
+	inline void fromQTangent(const float * const &q, double * const &normal, double * const &tangent, double * const &binormal) {
+		const double x = q[0], y = q[1], z = q[2], w = q[3];
+		const double handedness = w < 0. ? -1. : 1.;
+		tangent[0] = 1. - 2.*(y*y + z*z); tangent[1] = 2.*(x*y + w*z); tangent[2] = 2.*(x*z - w*y);
+		binormal[0] = handedness * 2.*(x*y - w*z); binormal[1] = handedness * (1. - 2.*(x*x + z*z)); binormal[2] = handedness * 2.*(y*z + w*x);
+		normal[0] = 2.*(x*z + w*y); normal[1] = 2.*(y*z - w*x); normal[2] = 1. - 2.*(x*x + y*y);
+	}
+
+	// The angle (in radians) below which two rotations of an animation are considered equal
+	#define KEYFRAME_ANGLE_EPSILON 0.000002
+
+	// The number of animation samples per additional thread, below that importing another copy of the scene doesn't pay off
+	#define ANIMATION_SAMPLES_PER_THREAD 20000
+
+	// The maximum number of frames between two samples of a slow animation curve
+	#define ANIMATION_MAX_SAMPLE_STRIDE 16
+
 	// Provides information about an animation
 	struct AnimInfo {
 		float start;
 		float stop;
 		float framerate;
+		// The rate at which each channel needs to be sampled, at most the framerate
+		float translationRate;
+		float rotationRate;
+		float scaleRate;
 		bool translate;
 		bool rotate;
 		bool scale;
 
-		AnimInfo() : start(FLT_MAX), stop(-1.f), framerate(0.f), translate(false), rotate(false), scale(false) {}
+		AnimInfo() : start(FLT_MAX), stop(-1.f), framerate(0.f), translationRate(0.f), rotationRate(0.f), scaleRate(0.f), translate(false), rotate(false), scale(false) {}
 
 		inline AnimInfo& operator+=(const AnimInfo& rhs) {
 			start = std::min(rhs.start, start);
 			stop = std::max(rhs.stop, stop);
 			framerate = std::max(rhs.framerate, framerate);
+			translationRate = std::max(rhs.translationRate, translationRate);
+			rotationRate = std::max(rhs.rotationRate, rotationRate);
+			scaleRate = std::max(rhs.scaleRate, scaleRate);
 			translate = translate || rhs.translate;
 			rotate = rotate || rhs.rotate;
 			scale = scale || rhs.scale;